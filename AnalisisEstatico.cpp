@@ -0,0 +1,916 @@
+#include "EnsambladorIA32.hpp"
+
+#include <cstdio>
+#include <map>
+
+using namespace std;
+
+// --- ANÁLISIS ESTÁTICO DE RENDIMIENTO (--analizar) ---
+// Decodifica los bytes ya emitidos en .text (las formas que genera este
+// ensamblador, también las de -O1 y los NOP de ALIGN), los parte en bloques
+// básicos por etiquetas, destinos de salto y fin de los saltos, y estima
+// para cada bloque, con la tabla del procesador elegido:
+//
+//   dependencias  la cadena de latencias más larga; en un bucle (bloque
+//                 que termina saltando a su propio inicio) la que pasa de
+//                 una iteración a la siguiente
+//   puertos       uops por iteración en el puerto más cargado; una uop que
+//                 puede ir a k puertos suma 1/k a cada uno
+//   front-end     uops por iteración / uops que se emiten por ciclo
+//
+// Los ciclos por iteración son el mayor de los tres, como en llvm-mca. Es
+// una estimación: no se modelan cachés, predicción de saltos ni alias de
+// memoria, salvo leer la misma dirección simbólica que se acaba de escribir.
+
+struct ModeloMicro {
+    const char* nombre;
+    uint8_t ancho;                  // uops que el front-end entrega por ciclo
+    uint8_t num_puertos;
+    const char* puertos[8];
+
+    // Puertos (máscara de bits) de cada tipo de uop; 0 = no hay uop aparte
+    uint8_t alu;
+    uint8_t desplazamiento;
+    uint8_t lea;
+    uint8_t lea_compleja;           // base + índice + desplazamiento
+    uint8_t multiplicacion;
+    uint8_t division;
+    uint8_t salto;
+    uint8_t carga;
+    uint8_t dir_escritura;
+    uint8_t dato_escritura;
+
+    // Latencias en ciclos
+    uint8_t lat_carga;
+    uint8_t lat_reenvio;            // escritura -> lectura de la misma dirección
+    uint8_t lat_lea_compleja;
+    uint8_t lat_mul;                // IMUL r32, r/m32
+    uint8_t lat_mul_ancha;          // MUL r/m32 (EDX:EAX)
+    uint8_t lat_div;
+    uint8_t lat_xchg_memoria;       // XCHG con memoria lleva LOCK implícito
+
+    uint8_t ocupacion_div;          // ciclos en que el divisor no acepta otra
+    uint8_t uops_loop;              // LOOP: uops de ALU además de la del salto
+};
+
+static const ModeloMicro MODELOS[] = {
+    // Intel Skylake: p0 p1 p5 p6 enteros, p2 p3 cargas, p4 dato y p7
+    // dirección de escritura. LOOP son 7 uops.
+    {"skylake", 4, 8, {"p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7"},
+     0x63, 0x41, 0x22, 0x02, 0x02, 0x01, 0x41, 0x0C, 0x8C, 0x10,
+     5, 4, 3, 3, 4, 26, 18, 6, 6},
+    // AMD Zen 2: ALU0-3 enteros, AGU0-2 direcciones de carga y escritura
+    {"zen2", 5, 7, {"alu0", "alu1", "alu2", "alu3", "agu0", "agu1", "agu2"},
+     0x0F, 0x06, 0x0F, 0x0F, 0x02, 0x04, 0x09, 0x70, 0x70, 0x00,
+     4, 4, 2, 3, 3, 17, 8, 17, 0},
+    // Intel Silvermont: IEC0 e IEC1 enteros, MEC memoria; en orden a 2 por ciclo
+    {"silvermont", 2, 3, {"iec0", "iec1", "mec"},
+     0x03, 0x01, 0x04, 0x04, 0x01, 0x01, 0x02, 0x04, 0x04, 0x00,
+     3, 3, 1, 3, 5, 25, 8, 25, 1},
+};
+
+bool buscar_microarquitectura(string_view nombre, Microarquitectura& micro) {
+    for (size_t i = 0; i < sizeof(MODELOS) / sizeof(MODELOS[0]); ++i) {
+        const string_view modelo = MODELOS[i].nombre;
+        if (modelo.size() != nombre.size()) continue;
+        size_t j = 0;
+        while (j < modelo.size() && a_mayuscula(nombre[j]) == a_mayuscula(modelo[j])) ++j;
+        if (j == modelo.size()) {
+            micro = static_cast<Microarquitectura>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- DECODIFICACIÓN ---
+
+enum class ClaseCalculo : uint8_t {
+    Alu,
+    CeroModismo,        // XOR r, r / SUB r, r: no depende de r ni usa puerto
+    Mov,                // sin uop de cálculo si lee o escribe memoria
+    Desplazamiento,
+    Lea,
+    LeaCompleja,
+    Multiplicacion,
+    MultiplicacionAncha,
+    Division,
+    Xchg,
+    Salto,
+    Bucle,              // LOOP
+    Llamada,
+    Retorno,
+    Nop,
+    Interrupcion        // INT: no se modela lo que hace el sistema
+};
+
+constexpr uint16_t BANDERAS = 1u << 8;      // junto a los 8 registros
+
+static uint16_t bit(int reg) {
+    return static_cast<uint16_t>(1u << reg);
+}
+
+struct InstruccionAnalizada {
+    uint32_t direccion = 0;
+    uint8_t largo = 0;
+    ClaseCalculo clase = ClaseCalculo::Alu;
+    bool carga = false;             // lee memoria
+    bool escritura = false;         // escribe memoria
+    bool fin_bloque = false;        // JMP, Jcc, LOOP, RET, INT
+    bool tiene_destino = false;     // salto o CALL relativo
+    uint32_t destino = 0;
+    uint16_t lee = 0;               // registros y banderas que usa el cálculo
+    uint16_t escribe = 0;
+    uint16_t lee_direccion = 0;     // base e índice de la memoria
+    uint64_t clave_memoria = 0;     // dirección simbólica (0 = no se sigue)
+    string texto;
+};
+
+static const char* const REG32[8] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
+static const char* const REG8[8] = {"al", "cl", "dl", "bl", "ah", "ch", "dh", "bh"};
+static const char* const NOMBRES_ALU[8] = {"add", "or", "adc", "sbb", "and", "sub", "xor", "cmp"};
+static const char* const NOMBRES_JCC[16] = {"jo", "jno", "jb", "jae", "je", "jne", "jbe", "ja",
+                                            "js", "jns", "jp", "jnp", "jl", "jge", "jle", "jg"};
+
+// Etiquetas por dirección, para mostrar destinos y direcciones absolutas
+class TablaNombres {
+    vector<pair<uint32_t, string_view>> entradas;   // ordenadas por dirección
+
+public:
+    void agregar(uint32_t direccion, string_view nombre) { entradas.emplace_back(direccion, nombre); }
+    void ordenar() { stable_sort(entradas.begin(), entradas.end(),
+                                 [](const auto& a, const auto& b) { return a.first < b.first; }); }
+
+    // Primera etiqueta definida en 'direccion' (vacía si no hay)
+    string_view buscar(uint32_t direccion) const {
+        auto it = lower_bound(entradas.begin(), entradas.end(), direccion,
+                              [](const auto& e, uint32_t d) { return e.first < d; });
+        return it != entradas.end() && it->first == direccion ? it->second : string_view();
+    }
+    string direccion_o_nombre(uint32_t direccion) const {
+        const string_view nombre = buscar(direccion);
+        if (!nombre.empty()) return string(nombre);
+        char buf[16];
+        snprintf(buf, sizeof(buf), "0x%X", direccion);
+        return buf;
+    }
+};
+
+// Lectura acotada de los bytes de .text
+struct LectorCodigo {
+    const uint8_t* codigo;
+    uint32_t fin;
+    uint32_t pos;
+    bool ok = true;
+
+    uint8_t u8() {
+        if (pos >= fin) {
+            ok = false;
+            return 0;
+        }
+        return codigo[pos++];
+    }
+    uint32_t u32() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(u8()) << (8 * i);
+        return v;
+    }
+};
+
+struct OperandoRM {
+    uint8_t reg = 0;        // campo /r
+    uint8_t rm = 0;
+    bool memoria = false;
+    int8_t base = -1;
+    int8_t indice = -1;
+    uint8_t escala = 1;
+    int32_t disp = 0;
+};
+
+static bool leer_modrm(LectorCodigo& l, OperandoRM& o) {
+    const uint8_t modrm = l.u8();
+    const uint8_t mod = modrm >> 6;
+    o.reg = (modrm >> 3) & 7;
+    o.rm = modrm & 7;
+    o.memoria = mod != 0b11;
+    if (!o.memoria) return l.ok;
+    if (o.rm == 0b100) {
+        const uint8_t sib = l.u8();
+        o.escala = static_cast<uint8_t>(1u << (sib >> 6));
+        if (((sib >> 3) & 7) != 0b100) o.indice = static_cast<int8_t>((sib >> 3) & 7);
+        if ((sib & 7) == 0b101 && mod == 0b00) o.disp = static_cast<int32_t>(l.u32());
+        else o.base = static_cast<int8_t>(sib & 7);
+    } else if (o.rm == 0b101 && mod == 0b00) {
+        o.disp = static_cast<int32_t>(l.u32());
+    } else {
+        o.base = static_cast<int8_t>(o.rm);
+    }
+    if (mod == 0b01) o.disp = static_cast<int8_t>(l.u8());
+    else if (mod == 0b10) o.disp = static_cast<int32_t>(l.u32());
+    return l.ok;
+}
+
+static string texto_rm(const OperandoRM& o, const TablaNombres& nombres, bool byte = false) {
+    if (!o.memoria) return byte ? REG8[o.rm] : REG32[o.rm];
+    string t = byte ? "byte [" : "[";
+    if (o.base < 0 && o.indice < 0) {
+        t += nombres.direccion_o_nombre(static_cast<uint32_t>(o.disp));
+        return t + "]";
+    }
+    if (o.base >= 0) t += REG32[o.base];
+    if (o.indice >= 0) {
+        if (o.base >= 0) t += "+";
+        t += REG32[o.indice];
+        if (o.escala > 1) t += "*" + to_string(o.escala);
+    }
+    if (o.disp > 0) t += "+" + to_string(o.disp);
+    else if (o.disp < 0) t += to_string(o.disp);
+    return t + "]";
+}
+
+static string texto_inmediato(uint32_t valor) {
+    if (valor < 10) return to_string(valor);
+    char buf[16];
+    snprintf(buf, sizeof(buf), "0x%X", valor);
+    return buf;
+}
+
+static void usar_memoria(InstruccionAnalizada& ins, const OperandoRM& o, bool lee_mem, bool escribe_mem) {
+    ins.carga |= lee_mem;
+    ins.escritura |= escribe_mem;
+    if (o.base >= 0) ins.lee_direccion |= bit(o.base);
+    if (o.indice >= 0) ins.lee_direccion |= bit(o.indice);
+    ins.clave_memoria = (1ull << 48) | (static_cast<uint64_t>(o.base + 1) << 40) |
+                        (static_cast<uint64_t>(o.indice + 1) << 36) | (static_cast<uint64_t>(o.escala) << 32) |
+                        static_cast<uint32_t>(o.disp);
+}
+
+// Operación de ALU 'ext' (0 ADD ... 7 CMP) sobre r/m con un registro o un
+// inmediato (fuente < 0)
+static void semantica_alu(InstruccionAnalizada& ins, uint8_t ext, const OperandoRM& o, int fuente) {
+    const bool escribe_destino = ext != 7;
+    ins.clase = ClaseCalculo::Alu;
+    ins.escribe |= BANDERAS;
+    if (ext == 2 || ext == 3) ins.lee |= BANDERAS;      // ADC/SBB
+    if (fuente >= 0) ins.lee |= bit(fuente);
+    if (o.memoria) {
+        usar_memoria(ins, o, true, escribe_destino);
+        return;
+    }
+    ins.lee |= bit(o.rm);
+    if (escribe_destino) ins.escribe |= bit(o.rm);
+    if (fuente == o.rm && (ext == 5 || ext == 6)) {
+        ins.lee = 0;
+        ins.clase = ClaseCalculo::CeroModismo;
+    }
+}
+
+static void salto_relativo(InstruccionAnalizada& ins, const LectorCodigo& l, int32_t rel, const char* mnemonico,
+                           const TablaNombres& nombres) {
+    ins.tiene_destino = true;
+    ins.destino = l.pos + static_cast<uint32_t>(rel);
+    ins.texto = string(mnemonico) + " " + nombres.direccion_o_nombre(ins.destino);
+}
+
+// Decodifica la instrucción en l.pos. Devuelve false ante bytes que este
+// ensamblador no emite como código (datos dentro de .text)
+static bool decodificar(LectorCodigo& l, const TablaNombres& nombres, InstruccionAnalizada& ins) {
+    ins = InstruccionAnalizada();
+    ins.direccion = l.pos;
+    OperandoRM o;
+    uint8_t op = l.u8();
+
+    if (op == 0x66) {
+        // Solo en los NOP de relleno de ALIGN
+        op = l.u8();
+        ins.clase = ClaseCalculo::Nop;
+        if (op == 0x90) {
+            ins.texto = "xchg ax, ax";
+        } else if (op == 0x0F && l.u8() == 0x1F && leer_modrm(l, o) && o.memoria) {
+            ins.texto = "nop word " + texto_rm(o, nombres);
+        } else {
+            return false;
+        }
+    } else if (op < 0x40 && ((op & 7) == 1 || (op & 7) == 3 || (op & 7) == 5)) {
+        // ALU: r/m, r (x1), r, r/m (x3) y EAX, imm32 (x5)
+        const uint8_t ext = op >> 3;
+        if ((op & 7) == 5) {
+            const uint32_t imm = l.u32();
+            o.rm = 0;
+            semantica_alu(ins, ext, o, -1);
+            ins.texto = string(NOMBRES_ALU[ext]) + " eax, " + texto_inmediato(imm);
+        } else if (!leer_modrm(l, o)) {
+            return false;
+        } else if ((op & 7) == 1) {
+            semantica_alu(ins, ext, o, o.reg);
+            ins.texto = string(NOMBRES_ALU[ext]) + " " + texto_rm(o, nombres) + ", " + REG32[o.reg];
+        } else {
+            OperandoRM destino;
+            destino.rm = o.reg;
+            semantica_alu(ins, ext, destino, o.memoria ? -1 : o.rm);
+            if (o.memoria) usar_memoria(ins, o, true, false);
+            ins.texto = string(NOMBRES_ALU[ext]) + " " + REG32[o.reg] + ", " + texto_rm(o, nombres);
+        }
+    } else if (op >= 0x40 && op <= 0x4F) {
+        const uint8_t r = op & 7;
+        ins.lee = bit(r);
+        ins.escribe = bit(r) | BANDERAS;
+        ins.texto = string(op < 0x48 ? "inc " : "dec ") + REG32[r];
+    } else if (op >= 0x50 && op <= 0x57) {
+        ins.clase = ClaseCalculo::Mov;
+        ins.lee = bit(op & 7);
+        ins.escritura = true;
+        ins.lee_direccion = bit(4);
+        ins.texto = string("push ") + REG32[op & 7];
+    } else if (op >= 0x58 && op <= 0x5F) {
+        ins.clase = ClaseCalculo::Mov;
+        ins.escribe = bit(op & 7);
+        ins.carga = true;
+        ins.lee_direccion = bit(4);
+        ins.texto = string("pop ") + REG32[op & 7];
+    } else if (op >= 0x70 && op <= 0x7F) {
+        ins.clase = ClaseCalculo::Salto;
+        ins.lee = BANDERAS;
+        ins.fin_bloque = true;
+        salto_relativo(ins, l, static_cast<int8_t>(l.u8()), NOMBRES_JCC[op & 0x0F], nombres);
+    } else if (op >= 0x91 && op <= 0x97) {
+        ins.clase = ClaseCalculo::Xchg;
+        ins.lee = ins.escribe = bit(0) | bit(op & 7);
+        ins.texto = string("xchg eax, ") + REG32[op & 7];
+    } else if (op >= 0xB8 && op <= 0xBF) {
+        ins.clase = ClaseCalculo::Mov;
+        ins.escribe = bit(op & 7);
+        ins.texto = string("mov ") + REG32[op & 7] + ", " + texto_inmediato(l.u32());
+    } else {
+        switch (op) {
+            case 0x0F: {
+                const uint8_t op2 = l.u8();
+                if (op2 >= 0x80 && op2 <= 0x8F) {
+                    ins.clase = ClaseCalculo::Salto;
+                    ins.lee = BANDERAS;
+                    ins.fin_bloque = true;
+                    const int32_t rel = static_cast<int32_t>(l.u32());
+                    salto_relativo(ins, l, rel, NOMBRES_JCC[op2 & 0x0F], nombres);
+                    break;
+                }
+                if (!leer_modrm(l, o)) return false;
+                if (op2 == 0xAF) {
+                    // IMUL r32, r/m32
+                    ins.clase = ClaseCalculo::Multiplicacion;
+                    ins.lee = bit(o.reg);
+                    ins.escribe = bit(o.reg) | BANDERAS;
+                    if (o.memoria) usar_memoria(ins, o, true, false);
+                    else ins.lee |= bit(o.rm);
+                    ins.texto = string("imul ") + REG32[o.reg] + ", " + texto_rm(o, nombres);
+                } else if (op2 == 0xB6) {
+                    ins.clase = ClaseCalculo::Mov;
+                    ins.escribe = bit(o.reg);
+                    if (o.memoria) usar_memoria(ins, o, true, false);
+                    else ins.lee = bit(o.rm & 3);   // AL..BL y AH..BH
+                    ins.texto = string("movzx ") + REG32[o.reg] + ", " + texto_rm(o, nombres, true);
+                } else if (op2 == 0x1F && o.memoria) {
+                    ins.clase = ClaseCalculo::Nop;
+                    ins.texto = "nop dword " + texto_rm(o, nombres);
+                } else {
+                    return false;
+                }
+                break;
+            }
+            case 0x68:
+            case 0x6A: {
+                const uint32_t imm = op == 0x68 ? l.u32() : static_cast<uint32_t>(static_cast<int8_t>(l.u8()));
+                ins.clase = ClaseCalculo::Mov;
+                ins.escritura = true;
+                ins.lee_direccion = bit(4);
+                ins.texto = "push " + texto_inmediato(imm);
+                break;
+            }
+            case 0x69:
+            case 0x6B: {
+                if (!leer_modrm(l, o)) return false;
+                const uint32_t imm = op == 0x69 ? l.u32() : static_cast<uint32_t>(static_cast<int8_t>(l.u8()));
+                ins.clase = ClaseCalculo::Multiplicacion;
+                ins.escribe = bit(o.reg) | BANDERAS;
+                if (o.memoria) usar_memoria(ins, o, true, false);
+                else ins.lee = bit(o.rm);
+                ins.texto = string("imul ") + REG32[o.reg] + ", " + texto_rm(o, nombres) + ", " + texto_inmediato(imm);
+                break;
+            }
+            case 0x80: {
+                if (!leer_modrm(l, o) || !o.memoria) return false;
+                const uint32_t imm = l.u8();
+                semantica_alu(ins, o.reg, o, -1);
+                ins.texto = string(NOMBRES_ALU[o.reg]) + " " + texto_rm(o, nombres, true) + ", " + texto_inmediato(imm);
+                break;
+            }
+            case 0x81:
+            case 0x83: {
+                if (!leer_modrm(l, o)) return false;
+                const uint32_t imm = op == 0x81 ? l.u32() : static_cast<uint32_t>(static_cast<int8_t>(l.u8()));
+                semantica_alu(ins, o.reg, o, -1);
+                ins.texto = string(NOMBRES_ALU[o.reg]) + " " + texto_rm(o, nombres) + ", " + texto_inmediato(imm);
+                break;
+            }
+            case 0x85:
+                if (!leer_modrm(l, o)) return false;
+                ins.lee = bit(o.reg);
+                ins.escribe = BANDERAS;
+                if (o.memoria) usar_memoria(ins, o, true, false);
+                else ins.lee |= bit(o.rm);
+                ins.texto = "test " + texto_rm(o, nombres) + ", " + REG32[o.reg];
+                break;
+            case 0x87:
+                if (!leer_modrm(l, o)) return false;
+                ins.clase = ClaseCalculo::Xchg;
+                ins.lee = ins.escribe = bit(o.reg);
+                if (o.memoria) usar_memoria(ins, o, true, true);
+                else ins.lee = ins.escribe = bit(o.reg) | bit(o.rm);
+                ins.texto = "xchg " + texto_rm(o, nombres) + ", " + REG32[o.reg];
+                break;
+            case 0x89:
+            case 0x8B:
+                if (!leer_modrm(l, o)) return false;
+                ins.clase = ClaseCalculo::Mov;
+                if (op == 0x89) {
+                    ins.lee = bit(o.reg);
+                    if (o.memoria) usar_memoria(ins, o, false, true);
+                    else ins.escribe = bit(o.rm);
+                    ins.texto = "mov " + texto_rm(o, nombres) + ", " + REG32[o.reg];
+                } else {
+                    ins.escribe = bit(o.reg);
+                    if (o.memoria) usar_memoria(ins, o, true, false);
+                    else ins.lee = bit(o.rm);
+                    ins.texto = string("mov ") + REG32[o.reg] + ", " + texto_rm(o, nombres);
+                }
+                break;
+            case 0x8D:
+                if (!leer_modrm(l, o) || !o.memoria) return false;
+                ins.clase = o.base >= 0 && o.indice >= 0 && o.disp != 0 ? ClaseCalculo::LeaCompleja
+                                                                         : ClaseCalculo::Lea;
+                if (o.base >= 0) ins.lee |= bit(o.base);
+                if (o.indice >= 0) ins.lee |= bit(o.indice);
+                ins.escribe = bit(o.reg);
+                ins.texto = string("lea ") + REG32[o.reg] + ", " + texto_rm(o, nombres);
+                break;
+            case 0x90:
+                ins.clase = ClaseCalculo::Nop;
+                ins.texto = "nop";
+                break;
+            case 0xA1:
+            case 0xA3:
+                o.memoria = true;
+                o.disp = static_cast<int32_t>(l.u32());
+                ins.clase = ClaseCalculo::Mov;
+                if (op == 0xA1) {
+                    usar_memoria(ins, o, true, false);
+                    ins.escribe = bit(0);
+                    ins.texto = "mov eax, " + texto_rm(o, nombres);
+                } else {
+                    usar_memoria(ins, o, false, true);
+                    ins.lee = bit(0);
+                    ins.texto = "mov " + texto_rm(o, nombres) + ", eax";
+                }
+                break;
+            case 0xC1:
+            case 0xD1: {
+                if (!leer_modrm(l, o) || o.reg != 4 || o.memoria) return false;
+                const uint32_t k = op == 0xC1 ? l.u8() : 1;
+                ins.clase = ClaseCalculo::Desplazamiento;
+                ins.lee = bit(o.rm);
+                ins.escribe = bit(o.rm) | BANDERAS;
+                ins.texto = string("shl ") + REG32[o.rm] + ", " + to_string(k);
+                break;
+            }
+            case 0xC3:
+                ins.clase = ClaseCalculo::Retorno;
+                ins.carga = true;
+                ins.lee_direccion = bit(4);
+                ins.fin_bloque = true;
+                ins.texto = "ret";
+                break;
+            case 0xC6: {
+                if (!leer_modrm(l, o) || o.reg != 0 || !o.memoria) return false;
+                const uint32_t imm = l.u8();
+                ins.clase = ClaseCalculo::Mov;
+                usar_memoria(ins, o, false, true);
+                ins.texto = "mov " + texto_rm(o, nombres, true) + ", " + texto_inmediato(imm);
+                break;
+            }
+            case 0xC7: {
+                if (!leer_modrm(l, o) || o.reg != 0) return false;
+                const uint32_t imm = l.u32();
+                ins.clase = ClaseCalculo::Mov;
+                if (o.memoria) usar_memoria(ins, o, false, true);
+                else ins.escribe = bit(o.rm);
+                ins.texto = "mov " + texto_rm(o, nombres) + ", " + texto_inmediato(imm);
+                break;
+            }
+            case 0xC9:
+                // MOV ESP, EBP + POP EBP
+                ins.clase = ClaseCalculo::Mov;
+                ins.carga = true;
+                ins.lee_direccion = bit(5);
+                ins.escribe = bit(5);
+                ins.texto = "leave";
+                break;
+            case 0xCD:
+                ins.clase = ClaseCalculo::Interrupcion;
+                ins.lee = 0xFF;
+                ins.escribe = bit(0);
+                ins.fin_bloque = true;
+                ins.texto = "int " + texto_inmediato(l.u8());
+                break;
+            case 0xE2:
+                ins.clase = ClaseCalculo::Bucle;
+                ins.lee = ins.escribe = bit(1);
+                ins.fin_bloque = true;
+                salto_relativo(ins, l, static_cast<int8_t>(l.u8()), "loop", nombres);
+                break;
+            case 0xE8: {
+                ins.clase = ClaseCalculo::Llamada;
+                ins.escritura = true;
+                ins.lee_direccion = bit(4);
+                const int32_t rel = static_cast<int32_t>(l.u32());
+                salto_relativo(ins, l, rel, "call", nombres);
+                break;
+            }
+            case 0xE9:
+            case 0xEB: {
+                ins.clase = ClaseCalculo::Salto;
+                ins.fin_bloque = true;
+                const int32_t rel = op == 0xE9 ? static_cast<int32_t>(l.u32()) : static_cast<int8_t>(l.u8());
+                salto_relativo(ins, l, rel, "jmp", nombres);
+                break;
+            }
+            case 0xF6:
+            case 0xF7:
+                if (!leer_modrm(l, o)) return false;
+                if (op == 0xF6 && !o.memoria) return false;
+                if (o.reg == 4) {
+                    ins.clase = ClaseCalculo::MultiplicacionAncha;
+                    ins.lee = bit(0);
+                } else if (o.reg == 6 || o.reg == 7) {
+                    ins.clase = ClaseCalculo::Division;
+                    ins.lee = bit(0) | bit(2);
+                } else {
+                    return false;
+                }
+                // La forma de 8 bits usa AX: EDX no cambia
+                if (op == 0xF6) ins.lee = bit(0);
+                ins.escribe = bit(0) | (op == 0xF7 ? bit(2) : 0) | BANDERAS;
+                if (o.memoria) usar_memoria(ins, o, true, false);
+                else ins.lee |= bit(o.rm);
+                ins.texto = string(o.reg == 4 ? "mul " : o.reg == 6 ? "div " : "idiv ") + texto_rm(o, nombres, op == 0xF6);
+                break;
+            case 0xFF:
+                // PUSH r/m32
+                if (!leer_modrm(l, o) || o.reg != 6) return false;
+                ins.clase = ClaseCalculo::Mov;
+                if (o.memoria) usar_memoria(ins, o, true, false);
+                else ins.lee = bit(o.rm);
+                ins.escritura = true;
+                ins.lee_direccion |= bit(4);
+                ins.clave_memoria = 0;
+                ins.texto = "push dword " + texto_rm(o, nombres);
+                break;
+            default:
+                return false;
+        }
+    }
+    if (!l.ok) return false;
+    ins.largo = static_cast<uint8_t>(l.pos - ins.direccion);
+    return true;
+}
+
+// --- COSTO SEGÚN EL MODELO ---
+
+struct CostoInstruccion {
+    uint8_t latencia = 0;       // del cálculo, sin la carga
+    uint8_t uops = 0;           // en el front-end (carga y cálculo fusionados)
+    uint8_t num = 0;            // uops con puerto
+    uint8_t puertos[10] = {};
+    uint8_t pesos[10] = {};     // ciclos que ocupan su puerto
+};
+
+static void agregar_uop(CostoInstruccion& c, uint8_t puertos, uint8_t peso = 1) {
+    if (puertos == 0 || c.num == sizeof(c.puertos)) return;
+    c.puertos[c.num] = puertos;
+    c.pesos[c.num] = peso;
+    ++c.num;
+}
+
+static CostoInstruccion costo(const InstruccionAnalizada& ins, const ModeloMicro& m) {
+    CostoInstruccion c;
+    uint8_t calculo = 1;        // uops de cálculo
+    switch (ins.clase) {
+        case ClaseCalculo::Alu:
+            c.latencia = 1;
+            agregar_uop(c, m.alu);
+            break;
+        case ClaseCalculo::CeroModismo:
+        case ClaseCalculo::Nop:
+            break;
+        case ClaseCalculo::Mov:
+            if (ins.carga || ins.escritura) {
+                calculo = 0;
+            } else {
+                c.latencia = 1;
+                agregar_uop(c, m.alu);
+            }
+            break;
+        case ClaseCalculo::Desplazamiento:
+            c.latencia = 1;
+            agregar_uop(c, m.desplazamiento);
+            break;
+        case ClaseCalculo::Lea:
+            c.latencia = 1;
+            agregar_uop(c, m.lea);
+            break;
+        case ClaseCalculo::LeaCompleja:
+            c.latencia = m.lat_lea_compleja;
+            agregar_uop(c, m.lea_compleja);
+            break;
+        case ClaseCalculo::Multiplicacion:
+            c.latencia = m.lat_mul;
+            agregar_uop(c, m.multiplicacion);
+            break;
+        case ClaseCalculo::MultiplicacionAncha:
+            c.latencia = m.lat_mul_ancha;
+            agregar_uop(c, m.multiplicacion);
+            agregar_uop(c, m.alu);      // parte alta a EDX
+            calculo = 2;
+            break;
+        case ClaseCalculo::Division:
+            c.latencia = m.lat_div;
+            agregar_uop(c, m.division, m.ocupacion_div);
+            break;
+        case ClaseCalculo::Xchg:
+            c.latencia = ins.carga ? m.lat_xchg_memoria : 2;
+            for (int i = 0; i < 3; ++i) agregar_uop(c, m.alu);
+            calculo = 3;
+            break;
+        case ClaseCalculo::Salto:
+        case ClaseCalculo::Llamada:
+        case ClaseCalculo::Retorno:
+        case ClaseCalculo::Interrupcion:
+            agregar_uop(c, m.salto);
+            break;
+        case ClaseCalculo::Bucle:
+            c.latencia = 1;
+            for (int i = 0; i < m.uops_loop; ++i) agregar_uop(c, m.alu);
+            agregar_uop(c, m.salto);
+            calculo = static_cast<uint8_t>(1 + m.uops_loop);
+            break;
+    }
+    if (ins.carga) agregar_uop(c, m.carga);
+    if (ins.escritura) {
+        agregar_uop(c, m.dir_escritura);
+        agregar_uop(c, m.dato_escritura);
+    }
+    c.uops = static_cast<uint8_t>(max<uint8_t>(1, calculo) + (ins.escritura && calculo > 0 ? 1 : 0));
+    return c;
+}
+
+// --- SIMULACIÓN DE DEPENDENCIAS ---
+
+struct NodoCadena {
+    uint32_t fin = 0;           // ciclo en que el resultado está listo
+    int32_t previo = -1;        // nodo que lo demoró (-1 = ninguno)
+};
+
+// Ejecuta 'iteraciones' veces el bloque [inicio, fin) sin límite de puertos.
+// Los nodos quedan en orden: iteración * n + instrucción.
+static void simular_dependencias(const vector<InstruccionAnalizada>& ins, size_t inicio, size_t fin,
+                                 const vector<CostoInstruccion>& costos, const ModeloMicro& m,
+                                 uint32_t iteraciones, vector<NodoCadena>& nodos) {
+    const size_t n = fin - inicio;
+    nodos.assign(n * iteraciones, NodoCadena());
+    uint32_t listo[9] = {};
+    int32_t productor[9];
+    for (int32_t& p : productor) p = -1;
+    map<uint64_t, pair<uint32_t, int32_t>> memoria;     // clave -> (listo, productor)
+
+    for (uint32_t k = 0; k < iteraciones; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+            const InstruccionAnalizada& a = ins[inicio + j];
+            NodoCadena& nodo = nodos[k * n + j];
+            uint32_t t = 0;
+            int32_t previo = -1;
+            auto esperar = [&](uint32_t listo_en, int32_t quien) {
+                if (listo_en > t || (listo_en == t && previo < 0 && quien >= 0)) {
+                    t = listo_en;
+                    previo = quien;
+                }
+            };
+            for (int r = 0; r < 9; ++r) {
+                if (a.lee & (1u << r)) esperar(listo[r], productor[r]);
+            }
+            if (a.carga) {
+                uint32_t td = 0;
+                int32_t pd = -1;
+                for (int r = 0; r < 8; ++r) {
+                    if ((a.lee_direccion & (1u << r)) && listo[r] >= td) {
+                        td = listo[r];
+                        pd = productor[r];
+                    }
+                }
+                uint32_t tc = td + m.lat_carga;
+                auto escrita = a.clave_memoria ? memoria.find(a.clave_memoria) : memoria.end();
+                if (escrita != memoria.end() && escrita->second.first + m.lat_reenvio > tc) {
+                    tc = escrita->second.first + m.lat_reenvio;
+                    pd = escrita->second.second;
+                }
+                esperar(tc, pd);
+            }
+            nodo.fin = t + costos[inicio + j].latencia;
+            nodo.previo = previo;
+            const int32_t yo = static_cast<int32_t>(k * n + j);
+            for (int r = 0; r < 9; ++r) {
+                if (a.escribe & (1u << r)) {
+                    listo[r] = nodo.fin;
+                    productor[r] = yo;
+                }
+            }
+            if (a.escritura && a.clave_memoria) memoria[a.clave_memoria] = {nodo.fin, yo};
+        }
+    }
+}
+
+// --- INFORME ---
+
+static const uint32_t ITERACIONES_BUCLE = 16;
+
+static string texto_ciclos(double c) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.2f", c);
+    return buf;
+}
+
+bool EnsambladorIA32::generar_analisis(const string& archivo_salida, Microarquitectura micro) const {
+    const ModeloMicro& m = MODELOS[static_cast<size_t>(micro)];
+    const uint32_t tam_text = min<uint32_t>(tamano_secciones[static_cast<size_t>(Seccion::Text)],
+                                            static_cast<uint32_t>(codigo_hex.size()));
+
+    TablaNombres nombres;
+    vector<uint32_t> etiquetas_text;
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] < 0) continue;
+        const uint32_t dir = static_cast<uint32_t>(tabla_simbolos[id]);
+        nombres.agregar(dir, simbolos.nombre(id));
+        if (seccion_simbolos[id] == Seccion::Text && dir < tam_text) etiquetas_text.push_back(dir);
+    }
+    nombres.ordenar();
+    sort(etiquetas_text.begin(), etiquetas_text.end());
+
+    // Decodificación lineal; los bytes que no son código se saltan hasta la
+    // siguiente etiqueta
+    vector<InstruccionAnalizada> ins;
+    vector<pair<uint32_t, uint32_t>> datos;             // [inicio, fin) no decodificados
+    LectorCodigo l{codigo_hex.data(), tam_text, 0};
+    while (l.pos < tam_text) {
+        InstruccionAnalizada a;
+        const uint32_t inicio = l.pos;
+        if (decodificar(l, nombres, a)) {
+            ins.push_back(move(a));
+            continue;
+        }
+        auto siguiente = upper_bound(etiquetas_text.begin(), etiquetas_text.end(), inicio);
+        l.pos = siguiente == etiquetas_text.end() ? tam_text : *siguiente;
+        l.ok = true;
+        datos.emplace_back(inicio, l.pos);
+    }
+
+    // Inicios de bloque: etiquetas, destinos de salto y lo que sigue a un
+    // salto, RET o INT
+    vector<bool> lider(tam_text + 1, false);
+    for (uint32_t d : etiquetas_text) lider[d] = true;
+    for (const InstruccionAnalizada& a : ins) {
+        if (a.tiene_destino && a.clase != ClaseCalculo::Llamada && a.destino < tam_text) lider[a.destino] = true;
+        if (a.fin_bloque) lider[a.direccion + a.largo] = true;
+    }
+
+    ofstream salida(archivo_salida);
+    salida << "Analisis estatico de .text (" << m.nombre << ", " << static_cast<int>(m.ancho)
+           << " uops por ciclo; estimacion con latencias y puertos aproximados)\n";
+    for (const auto& d : datos) {
+        char buf[96];
+        snprintf(buf, sizeof(buf), "Datos o bytes no reconocidos en [0x%X, 0x%X): se omiten\n", d.first, d.second);
+        salida << buf;
+    }
+
+    vector<CostoInstruccion> costos;
+    costos.reserve(ins.size());
+    for (const InstruccionAnalizada& a : ins) costos.push_back(costo(a, m));
+
+    vector<NodoCadena> nodos;
+    size_t inicio = 0;
+    while (inicio < ins.size()) {
+        size_t fin = inicio + 1;
+        while (fin < ins.size() && !lider[ins[fin].direccion] &&
+               ins[fin].direccion == ins[fin - 1].direccion + ins[fin - 1].largo && !ins[fin - 1].fin_bloque) {
+            ++fin;
+        }
+        const size_t n = fin - inicio;
+        const InstruccionAnalizada& ultima = ins[fin - 1];
+        const uint32_t dir_inicio = ins[inicio].direccion;
+        const bool bucle = ultima.tiene_destino && ultima.clase != ClaseCalculo::Llamada &&
+                           ultima.destino == dir_inicio;
+
+        // Puertos y front-end por iteración
+        double presion[8] = {};
+        uint32_t uops = 0;
+        bool no_modelada = false;
+        for (size_t i = inicio; i < fin; ++i) {
+            const CostoInstruccion& c = costos[i];
+            uops += c.uops;
+            for (uint8_t u = 0; u < c.num; ++u) {
+                const int k = __builtin_popcount(c.puertos[u]);
+                for (int p = 0; p < m.num_puertos; ++p) {
+                    if (c.puertos[u] & (1u << p)) presion[p] += static_cast<double>(c.pesos[u]) / k;
+                }
+            }
+            if (ins[i].clase == ClaseCalculo::Interrupcion) no_modelada = true;
+        }
+        double max_puerto = 0;
+        for (int p = 0; p < m.num_puertos; ++p) max_puerto = max(max_puerto, presion[p]);
+        const double front_end = static_cast<double>(uops) / m.ancho;
+
+        // Dependencias: en un bucle, ritmo estable entre iteraciones
+        const uint32_t iteraciones = bucle ? ITERACIONES_BUCLE : 1;
+        simular_dependencias(ins, inicio, fin, costos, m, iteraciones, nodos);
+        vector<uint32_t> fin_iteracion(iteraciones, 0);
+        size_t ultimo = (iteraciones - 1) * n;
+        for (uint32_t k = 0; k < iteraciones; ++k) {
+            for (size_t j = 0; j < n; ++j) {
+                const NodoCadena& nodo = nodos[k * n + j];
+                fin_iteracion[k] = max(fin_iteracion[k], nodo.fin);
+                if (k == iteraciones - 1 && nodo.fin >= nodos[ultimo].fin) ultimo = k * n + j;
+            }
+        }
+        double dependencias = fin_iteracion[iteraciones - 1];
+        if (bucle) {
+            const uint32_t mitad = iteraciones / 2;
+            dependencias = static_cast<double>(fin_iteracion[iteraciones - 1] - fin_iteracion[mitad - 1]) /
+                           (iteraciones - mitad);
+        }
+
+        double estimado = dependencias;
+        const char* cuello = "dependencias";
+        if (max_puerto > estimado) {
+            estimado = max_puerto;
+            cuello = "puertos";
+        }
+        if (front_end > estimado) {
+            estimado = front_end;
+            cuello = "front-end";
+        }
+
+        // Cabecera del bloque
+        const string_view nombre = nombres.buscar(dir_inicio);
+        char rango[48];
+        snprintf(rango, sizeof(rango), "[0x%X, 0x%X)", dir_inicio, ultima.direccion + ultima.largo);
+        salida << "\nBloque " << (nombre.empty() ? string("(sin etiqueta)") : string(nombre)) << ' ' << rango
+               << ": " << n << " instrucciones, " << uops << " uops" << (bucle ? ", bucle" : "") << '\n';
+        salida << "  " << (bucle ? "Ciclos por iteracion: " : "Ciclos (una pasada): ") << texto_ciclos(estimado)
+               << " (limita: " << cuello << ")\n";
+        salida << "    dependencias " << texto_ciclos(dependencias) << ", puertos " << texto_ciclos(max_puerto)
+               << ", front-end " << texto_ciclos(front_end) << '\n';
+        if (no_modelada) salida << "  Aviso: INT no se modela (el costo real depende del sistema)\n";
+
+        // Cadena crítica: hacia atrás desde el último resultado; en un bucle,
+        // hasta repetir una instrucción (se cerró el ciclo entre iteraciones)
+        vector<size_t> cadena;
+        vector<bool> vista(n, false);
+        for (int32_t nodo = static_cast<int32_t>(ultimo); nodo >= 0; nodo = nodos[nodo].previo) {
+            if (vista[static_cast<size_t>(nodo) % n]) break;
+            vista[static_cast<size_t>(nodo) % n] = true;
+            cadena.push_back(static_cast<size_t>(nodo));
+        }
+        reverse(cadena.begin(), cadena.end());
+        salida << "  Cadena critica" << (bucle ? " (entre iteraciones)" : "") << ":\n";
+        for (size_t c = 0; c < cadena.size(); ++c) {
+            const NodoCadena& nodo = nodos[cadena[c]];
+            const uint32_t antes = nodo.previo >= 0 ? nodos[nodo.previo].fin : 0;
+            const InstruccionAnalizada& a = ins[inicio + cadena[c] % n];
+            char linea[32];
+            snprintf(linea, sizeof(linea), "    0x%08X  +%-3u ", a.direccion, nodo.fin - antes);
+            salida << linea << a.texto << '\n';
+        }
+
+        salida << "  Presion por puerto (uops por iteracion):";
+        for (int p = 0; p < m.num_puertos; ++p) salida << ' ' << m.puertos[p] << '=' << texto_ciclos(presion[p]);
+        salida << '\n';
+
+        salida << "  Instrucciones:\n";
+        for (size_t i = inicio; i < fin; ++i) {
+            const InstruccionAnalizada& a = ins[i];
+            const CostoInstruccion& c = costos[i];
+            const uint32_t latencia = c.latencia + (a.carga ? m.lat_carga : 0);
+            char linea[48];
+            snprintf(linea, sizeof(linea), "    0x%08X  uops %u  lat %-3u ", a.direccion, c.uops, latencia);
+            salida << linea << a.texto << '\n';
+        }
+        inicio = fin;
+    }
+    return !salida.fail();
+}
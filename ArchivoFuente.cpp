@@ -0,0 +1,109 @@
+#include "ArchivoFuente.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define ARCHIVO_FUENTE_POSIX 1
+#endif
+
+using namespace std;
+
+ArchivoFuente::ArchivoFuente() : datos(nullptr), tamano(0), proyectado(false) {
+}
+
+ArchivoFuente::~ArchivoFuente() {
+    cerrar();
+}
+
+void ArchivoFuente::cerrar() {
+#ifdef ARCHIVO_FUENTE_POSIX
+    if (proyectado) {
+        munmap(const_cast<char*>(datos), tamano);
+    }
+#endif
+    datos = nullptr;
+    tamano = 0;
+    proyectado = false;
+    buffer.clear();
+}
+
+#ifdef ARCHIVO_FUENTE_POSIX
+
+// Lectura en bloque para lo que no se puede proyectar (tuberías, stdin)
+bool ArchivoFuente::leer_descriptor(int fd) {
+    const size_t BLOQUE = 1 << 20;
+    size_t usado = 0;
+    for (;;) {
+        if (buffer.size() < usado + BLOQUE) buffer.resize(usado + BLOQUE);
+        ssize_t n = read(fd, &buffer[usado], BLOQUE);
+        if (n < 0) return false;
+        if (n == 0) break;
+        usado += static_cast<size_t>(n);
+    }
+    buffer.resize(usado);
+    datos = buffer.data();
+    tamano = buffer.size();
+    return true;
+}
+
+bool ArchivoFuente::abrir(const string& ruta) {
+    cerrar();
+
+    if (ruta == "-") {
+        return leer_descriptor(STDIN_FILENO);
+    }
+
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (S_ISREG(info.st_mode)) {
+        if (info.st_size == 0) {
+            // mmap no admite longitud 0: archivo vacío
+            close(fd);
+            return true;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            // Se recorre una sola vez de principio a fin
+            madvise(p, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            close(fd); // la proyección sigue siendo válida
+            datos = static_cast<const char*>(p);
+            tamano = static_cast<size_t>(info.st_size);
+            proyectado = true;
+            return true;
+        }
+    }
+
+    bool ok = leer_descriptor(fd);
+    close(fd);
+    return ok;
+}
+
+#else
+
+bool ArchivoFuente::leer_descriptor(int) {
+    return false;
+}
+
+bool ArchivoFuente::abrir(const string& ruta) {
+    cerrar();
+    ifstream f(ruta, ios::binary);
+    if (!f.is_open()) return false;
+    buffer.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+    datos = buffer.data();
+    tamano = buffer.size();
+    return true;
+}
+
+#endif
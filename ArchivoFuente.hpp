@@ -0,0 +1,39 @@
+#ifndef ARCHIVO_FUENTE_HPP
+#define ARCHIVO_FUENTE_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+using namespace std;
+
+// --- LECTURA DE ARCHIVOS FUENTE ---
+// Los archivos regulares se proyectan en memoria de solo lectura (mmap) con
+// acceso secuencial, de modo que el ensamblador recorre las líneas sobre la
+// caché de páginas del sistema sin copiarlas. Tuberías y stdin ("-") no se
+// pueden proyectar: se leen de una vez a un único buffer.
+class ArchivoFuente {
+private:
+    const char* datos;
+    size_t tamano;
+    bool proyectado;
+    string buffer; // solo para tuberías, stdin o sistemas sin mmap
+
+    bool leer_descriptor(int fd);
+    void cerrar();
+
+public:
+    ArchivoFuente();
+    ~ArchivoFuente();
+
+    ArchivoFuente(const ArchivoFuente&) = delete;
+    ArchivoFuente& operator=(const ArchivoFuente&) = delete;
+
+    // Abre 'ruta' ("-" = entrada estándar). Devuelve false si no se pudo leer.
+    bool abrir(const string& ruta);
+
+    string_view contenido() const { return string_view(datos, tamano); }
+    bool es_proyectado() const { return proyectado; }
+};
+
+#endif // ARCHIVO_FUENTE_HPP
@@ -0,0 +1,134 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// --- ARENA DE MEMORIA ---
+// Todo lo temporal de una pasada de ensamblado (nombres de etiquetas, listas
+// de referencias, tablas del internador) se reserva por desplazamiento dentro
+// de unos pocos bloques grandes. Nada se libera por separado: reiniciar() deja
+// la arena vacía en O(1) y conserva la memoria para la siguiente pasada.
+
+class Arena {
+private:
+    struct Bloque {
+        unique_ptr<char[]> datos;
+        size_t capacidad;
+    };
+
+    static const size_t TAMANO_BLOQUE_MINIMO = 64 * 1024;
+
+    vector<Bloque> bloques;
+    size_t bloque_actual = 0;
+    char* cursor = nullptr;
+    char* limite = nullptr;
+
+    // Contadores para verificar que la ruta caliente no toca el heap
+    size_t asignaciones = 0;    // pedidos atendidos por la arena
+    size_t reservas_heap = 0;   // bloques pedidos al heap
+    size_t bytes_pedidos = 0;
+
+    void usar_bloque(size_t i) {
+        bloque_actual = i;
+        cursor = bloques[i].datos.get();
+        limite = cursor + bloques[i].capacidad;
+    }
+
+    // Pasa al siguiente bloque que tenga espacio, o reserva uno nuevo
+    void avanzar_bloque(size_t minimo) {
+        for (size_t i = bloques.empty() ? 0 : bloque_actual + 1; i < bloques.size(); ++i) {
+            if (bloques[i].capacidad >= minimo) {
+                usar_bloque(i);
+                return;
+            }
+        }
+
+        size_t capacidad = bloques.empty() ? TAMANO_BLOQUE_MINIMO : bloques.back().capacidad * 2;
+        if (capacidad < minimo) capacidad = minimo;
+        bloques.push_back({unique_ptr<char[]>(new char[capacidad]), capacidad});
+        ++reservas_heap;
+        usar_bloque(bloques.size() - 1);
+    }
+
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* asignar(size_t bytes, size_t alineacion = alignof(max_align_t)) {
+        ++asignaciones;
+        bytes_pedidos += bytes;
+
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + alineacion - 1) & ~(uintptr_t)(alineacion - 1);
+        if (cursor == nullptr || p + bytes > reinterpret_cast<uintptr_t>(limite)) {
+            avanzar_bloque(bytes + alineacion);
+            p = (reinterpret_cast<uintptr_t>(cursor) + alineacion - 1) & ~(uintptr_t)(alineacion - 1);
+        }
+        cursor = reinterpret_cast<char*>(p + bytes);
+        return reinterpret_cast<void*>(p);
+    }
+
+    // Solo recupera memoria si es lo último asignado (caso típico: un vector
+    // que crece); en cualquier otro caso no hace nada.
+    void liberar(void* p, size_t bytes) {
+        if (static_cast<char*>(p) + bytes == cursor) cursor = static_cast<char*>(p);
+    }
+
+    // Olvida todo lo asignado. Si la pasada anterior necesitó varios bloques,
+    // se sustituyen por uno solo del tamaño total para la próxima.
+    void reiniciar() {
+        if (bloques.size() > 1) {
+            size_t total = 0;
+            for (const auto& b : bloques) total += b.capacidad;
+            bloques.clear();
+            bloques.push_back({unique_ptr<char[]>(new char[total]), total});
+            ++reservas_heap;
+        }
+        if (!bloques.empty()) usar_bloque(0);
+        asignaciones = 0;
+        bytes_pedidos = 0;
+    }
+
+    size_t num_asignaciones() const { return asignaciones; }
+    size_t num_reservas_heap() const { return reservas_heap; }
+    size_t bytes_asignados() const { return bytes_pedidos; }
+    size_t bytes_reservados() const {
+        size_t total = 0;
+        for (const auto& b : bloques) total += b.capacidad;
+        return total;
+    }
+};
+
+// Asignador compatible con los contenedores estándar que reserva en una Arena
+template <typename T>
+struct AsignadorArena {
+    using value_type = T;
+
+    Arena* arena;
+
+    explicit AsignadorArena(Arena& a) : arena(&a) {}
+    template <typename U>
+    AsignadorArena(const AsignadorArena<U>& otro) : arena(otro.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->asignar(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        arena->liberar(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const AsignadorArena<U>& otro) const { return arena == otro.arena; }
+    template <typename U>
+    bool operator!=(const AsignadorArena<U>& otro) const { return arena != otro.arena; }
+};
+
+template <typename T>
+using VectorArena = vector<T, AsignadorArena<T>>;
+
+#endif // ARENA_HPP
@@ -0,0 +1,399 @@
+// --- BANCO DE PRUEBAS POR ETAPA ---
+// Mide por separado cada etapa del ensamblado sobre una fuente sintética
+// (GeneradorFuentes) o un archivo dado, e informa ns/línea, bytes de fuente
+// por segundo y asignaciones de memoria por línea. El resultado se puede
+// escribir en JSON para seguirlo entre versiones.
+//
+// Etapas, en el orden del ensamblado real:
+//   indice_estructural  indexar_estructura sobre toda la fuente
+//   lexico              lexar_linea de cada línea
+//   operandos           parsear_operando de cada operando de instrucción
+//   despacho            procesar_lexada de cada línea ya lexada (incluye
+//                       operandos y codificación, como procesar_instruccion)
+//   relajacion          relajar_saltos y ubicar_secciones
+//   resolver            resolver_referencias_pendientes
+//   generar_hex         generar_hex a un archivo
+//   generar_reportes    generar_reportes a dos archivos
+//   completo            ensamblar_memoria (un hilo) y resolver, de punta a punta
+//
+// Cada etapa corre -r veces; se informa la más rápida y la mediana. Las
+// asignaciones son las de la última corrida, con la arena ya reutilizada.
+
+#include "EnsambladorIA32.hpp"
+#include "GeneradorFuentes.hpp"
+#include "IndiceEstructural.hpp"
+#include "ArchivoFuente.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <new>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// -----------------------------------------------------------------------------
+// Conteo de asignaciones
+// -----------------------------------------------------------------------------
+// Reemplazar el operator new global cuenta también las asignaciones de la
+// biblioteca estándar dentro del ensamblador (vectores, cadenas, bloques de
+// la arena)
+
+static atomic<uint64_t> asignaciones(0);
+
+static void* asignar(size_t n) {
+    asignaciones.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(n != 0 ? n : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t n) { return asignar(n); }
+void* operator new[](size_t n) { return asignar(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// -----------------------------------------------------------------------------
+// Etapas
+// -----------------------------------------------------------------------------
+
+// Acceso a las etapas privadas del ensamblador (es amiga de EnsambladorIA32)
+class BancoEtapas {
+public:
+    static void parsear_operandos(EnsambladorIA32& e, const vector<string_view>& textos) {
+        Operando op;
+        for (string_view t : textos) e.parsear_operando(t, op);
+    }
+
+    // Lo mismo que procesar_fuente una vez lexadas las líneas
+    static void despachar(EnsambladorIA32& e, const vector<LineaLexada>& lineas) {
+        for (const LineaLexada& l : lineas) e.procesar_lexada(l);
+        e.cerrar_preprocesador();
+        e.cortar_optimizacion();
+    }
+
+    static void relajar(EnsambladorIA32& e) {
+        e.relajar_saltos();
+        e.ubicar_secciones();
+    }
+};
+
+struct OpcionesBanco {
+    MezclaFuente mezcla;
+    string fuente;              // archivo a medir; vacío = fuente generada
+    string guardar_fuente;      // dónde escribir la fuente generada
+    string json;                // "-" = salida estándar
+    string dir_salida;          // para generar_hex y generar_reportes
+    unsigned repeticiones = 5;
+};
+
+struct Medicion {
+    const char* nombre;
+    vector<double> segundos;
+    uint64_t asignaciones = 0;
+
+    double mejor() const { return *min_element(segundos.begin(), segundos.end()); }
+    double mediana() const {
+        vector<double> v = segundos;
+        sort(v.begin(), v.end());
+        return v[v.size() / 2];
+    }
+};
+
+// Mide 'etapa' y suma una corrida a 'm'
+template <typename F>
+static void medir(Medicion& m, F etapa) {
+    const uint64_t antes = asignaciones.load(memory_order_relaxed);
+    const auto inicio = chrono::steady_clock::now();
+    etapa();
+    const auto fin = chrono::steady_clock::now();
+    m.asignaciones = asignaciones.load(memory_order_relaxed) - antes;
+    m.segundos.push_back(chrono::duration<double>(fin - inicio).count());
+}
+
+// -----------------------------------------------------------------------------
+// Línea de comandos
+// -----------------------------------------------------------------------------
+
+static void mostrar_uso(const char* programa) {
+    const MezclaFuente d;
+    cerr << "Uso: " << programa << " [-r N] [--json ARCHIVO] [-d DIR] [--fuente ARCHIVO | opciones de mezcla]\n"
+         << "  -r N               corridas por etapa (por defecto, 5)\n"
+         << "  --json ARCHIVO     escribe los resultados en JSON (\"-\" = salida estandar)\n"
+         << "  -d DIR             directorio para las salidas de generar_hex y generar_reportes\n"
+         << "                     (por defecto, uno temporal)\n"
+         << "  --fuente ARCHIVO   mide un archivo en lugar de la fuente generada\n"
+         << "  --guardar-fuente ARCHIVO\n"
+         << "                     escribe la fuente generada\n"
+         << "Mezcla de la fuente generada (pesos relativos por clase de instruccion):\n"
+         << "  --lineas N         instrucciones (por defecto, " << d.lineas << ")\n"
+         << "  --semilla N        semilla del generador (por defecto, " << d.semilla << ")\n"
+         << "  --registros P      op r32, r32 (por defecto, " << d.registros << ")\n"
+         << "  --inmediatos P     op r32, imm (por defecto, " << d.inmediatos << ")\n"
+         << "  --memoria P        operando de memoria (por defecto, " << d.memoria << ")\n"
+         << "  --saltos P         saltos a etiquetas vecinas (por defecto, " << d.saltos << ")\n"
+         << "  --etiquetas N      una etiqueta cada N lineas; 0 = ninguna (por defecto, "
+         << d.lineas_por_etiqueta << ")\n"
+         << "  --dd N             dwords de una tabla grande en .data (por defecto, " << d.entradas_dd << ")\n";
+}
+
+static bool parsear_argumentos(int argc, char** argv, OpcionesBanco& op) {
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        auto valor = [&](string& destino) {
+            if (i + 1 >= argc) {
+                cerr << "Falta el valor de " << arg << endl;
+                return false;
+            }
+            destino = argv[++i];
+            return true;
+        };
+        auto numero = [&](uint32_t minimo, uint32_t& destino) {
+            string texto;
+            if (!valor(texto)) return false;
+            char* fin = nullptr;
+            const unsigned long v = strtoul(texto.c_str(), &fin, 0);
+            if (texto.empty() || *fin != '\0' || v < minimo || v > 0xFFFFFFFFul) {
+                cerr << "Valor invalido para " << arg << ": " << texto << endl;
+                return false;
+            }
+            destino = static_cast<uint32_t>(v);
+            return true;
+        };
+
+        MezclaFuente& m = op.mezcla;
+        uint32_t n = 0;
+        if (arg == "-h" || arg == "--ayuda") {
+            return false;
+        } else if (arg == "-r") {
+            if (!numero(1, n)) return false;
+            op.repeticiones = n;
+        } else if (arg == "--json") {
+            if (!valor(op.json)) return false;
+        } else if (arg == "-d") {
+            if (!valor(op.dir_salida)) return false;
+        } else if (arg == "--fuente") {
+            if (!valor(op.fuente)) return false;
+        } else if (arg == "--guardar-fuente") {
+            if (!valor(op.guardar_fuente)) return false;
+        } else if (arg == "--lineas") {
+            if (!numero(1, m.lineas)) return false;
+        } else if (arg == "--semilla") {
+            if (!numero(1, m.semilla)) return false;
+        } else if (arg == "--registros") {
+            if (!numero(0, m.registros)) return false;
+        } else if (arg == "--inmediatos") {
+            if (!numero(0, m.inmediatos)) return false;
+        } else if (arg == "--memoria") {
+            if (!numero(0, m.memoria)) return false;
+        } else if (arg == "--saltos") {
+            if (!numero(0, m.saltos)) return false;
+        } else if (arg == "--etiquetas") {
+            if (!numero(0, m.lineas_por_etiqueta)) return false;
+        } else if (arg == "--dd") {
+            if (!numero(0, m.entradas_dd)) return false;
+        } else {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Informe
+// -----------------------------------------------------------------------------
+
+// Cadena JSON: solo hace falta escapar comillas, barras y controles
+static string cadena_json(string_view s) {
+    string r = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            r.push_back('\\');
+            r.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char u[8];
+            snprintf(u, sizeof(u), "\\u%04x", static_cast<unsigned>(c));
+            r += u;
+        } else {
+            r.push_back(c);
+        }
+    }
+    return r + "\"";
+}
+
+static void escribir_json(ostream& s, const OpcionesBanco& op, uint64_t lineas, uint64_t bytes,
+                          size_t bytes_codigo, const vector<Medicion>& mediciones) {
+    const MezclaFuente& m = op.mezcla;
+    s << "{\n  \"version\": 1,\n"
+      << "  \"simd\": " << cadena_json(nivel_simd_indice()) << ",\n"
+      << "  \"repeticiones\": " << op.repeticiones << ",\n"
+      << "  \"fuente\": {\n"
+      << "    \"archivo\": " << (op.fuente.empty() ? string("null") : cadena_json(op.fuente)) << ",\n"
+      << "    \"lineas\": " << lineas << ",\n"
+      << "    \"bytes\": " << bytes << ",\n"
+      << "    \"bytes_codigo\": " << bytes_codigo;
+    if (op.fuente.empty()) {
+        s << ",\n    \"mezcla\": {\"lineas\": " << m.lineas << ", \"semilla\": " << m.semilla
+          << ", \"registros\": " << m.registros << ", \"inmediatos\": " << m.inmediatos
+          << ", \"memoria\": " << m.memoria << ", \"saltos\": " << m.saltos
+          << ", \"lineas_por_etiqueta\": " << m.lineas_por_etiqueta << ", \"entradas_dd\": " << m.entradas_dd << "}";
+    }
+    s << "\n  },\n  \"etapas\": [\n";
+    s << setprecision(6);
+    for (size_t i = 0; i < mediciones.size(); ++i) {
+        const Medicion& me = mediciones[i];
+        const double mejor = max(me.mejor(), 1e-12);
+        s << "    {\"nombre\": " << cadena_json(me.nombre) << ", \"segundos_mejor\": " << me.mejor()
+          << ", \"segundos_mediana\": " << me.mediana() << ", \"ns_por_linea\": " << mejor * 1e9 / lineas
+          << ", \"bytes_por_segundo\": " << bytes / mejor << ", \"asignaciones_por_linea\": "
+          << static_cast<double>(me.asignaciones) / lineas << "}" << (i + 1 < mediciones.size() ? "," : "")
+          << '\n';
+    }
+    s << "  ]\n}\n";
+}
+
+static void escribir_tabla(ostream& s, uint64_t lineas, uint64_t bytes, size_t bytes_codigo,
+                           const vector<Medicion>& mediciones) {
+    s << "Fuente: " << lineas << " lineas, " << bytes << " bytes; codigo: " << bytes_codigo << " bytes; SIMD "
+      << nivel_simd_indice() << "\n\n"
+      << left << setw(22) << "etapa" << right << setw(12) << "ns/linea" << setw(12) << "mediana" << setw(12)
+      << "MB/s" << setw(14) << "asign/linea" << '\n';
+    for (const Medicion& m : mediciones) {
+        const double mejor = max(m.mejor(), 1e-12);
+        s << left << setw(22) << m.nombre << right << fixed << setprecision(2) << setw(12) << mejor * 1e9 / lineas
+          << setw(12) << m.mediana() * 1e9 / lineas << setw(12) << bytes / mejor / 1e6 << setprecision(4)
+          << setw(14) << static_cast<double>(m.asignaciones) / lineas << '\n';
+    }
+    s.unsetf(ios::floatfield);
+}
+
+int main(int argc, char** argv) {
+    OpcionesBanco op;
+    if (!parsear_argumentos(argc, argv, op)) {
+        mostrar_uso(argv[0]);
+        return 2;
+    }
+
+    // Fuente: archivo dado o generada
+    string texto;
+    if (!op.fuente.empty()) {
+        ArchivoFuente f;
+        if (!f.abrir(op.fuente)) {
+            cerr << "No se pudo abrir el archivo: " << op.fuente << endl;
+            return 1;
+        }
+        texto.assign(f.contenido());
+    } else {
+        texto = generar_fuente(op.mezcla);
+        if (!op.guardar_fuente.empty()) {
+            ofstream g(op.guardar_fuente, ios::binary);
+            g << texto;
+            if (!g) {
+                cerr << "No se pudo escribir " << op.guardar_fuente << endl;
+                return 1;
+            }
+        }
+    }
+    const string_view fuente = texto;
+    const uint64_t num_lineas = max<uint64_t>(1, static_cast<uint64_t>(count(texto.begin(), texto.end(), '\n')));
+
+    error_code ec;
+    const fs::path dir = op.dir_salida.empty() ? fs::temp_directory_path(ec) / "banco_ensamblador"
+                                               : fs::path(op.dir_salida);
+    fs::create_directories(dir, ec);
+    const string ruta_hex = (dir / "banco.hex").string();
+    const string ruta_simbolos = (dir / "banco.simbolos.txt").string();
+    const string ruta_referencias = (dir / "banco.referencias.txt").string();
+
+    // Memoria de las etapas reservada fuera de la medición
+    vector<uint32_t> indice(texto.size());
+    vector<LineaLexada> lexadas;
+    lexadas.reserve(num_lineas + 1);
+    vector<string_view> operandos;
+
+    EnsambladorIA32 ensamblador;
+    EnsambladorIA32 completo;
+    ostringstream mensajes;
+    ensamblador.redirigir_errores(mensajes);
+    completo.redirigir_errores(mensajes);
+
+    vector<Medicion> mediciones = {{"indice_estructural", {}}, {"lexico", {}},      {"operandos", {}},
+                                   {"despacho", {}},           {"relajacion", {}},  {"resolver", {}},
+                                   {"generar_hex", {}},        {"generar_reportes", {}}, {"completo", {}}};
+    bool ok = true;
+    for (unsigned r = 0; r < op.repeticiones; ++r) {
+        size_t cuenta = 0;
+        medir(mediciones[0], [&] { cuenta = indexar_estructura(texto.data(), texto.size(), indice.data()); });
+        if (cuenta == 0 && !texto.empty()) indice[0] = 0; // que no se descarte la llamada
+
+        medir(mediciones[1], [&] {
+            lexadas.clear();
+            LineaLexada l;
+            size_t ini = 0;
+            while (ini < fuente.size()) {
+                const char* salto = static_cast<const char*>(memchr(fuente.data() + ini, '\n', fuente.size() - ini));
+                const size_t fin = salto ? static_cast<size_t>(salto - fuente.data()) : fuente.size();
+                if (lexar_linea(fuente.substr(ini, fin - ini), l)) lexadas.push_back(l);
+                ini = fin + 1;
+            }
+        });
+
+        // Los operandos de las instrucciones, como los separa procesar_instruccion
+        operandos.clear();
+        for (const LineaLexada& l : lexadas) {
+            const DescriptorInstruccion* desc = buscar_instruccion(l.mnemonico);
+            if (!l.etiqueta.empty() || desc == nullptr || desc->forma == FormaInstruccion::Directiva) continue;
+            if (l.dos_operandos) {
+                operandos.push_back(l.dest);
+                operandos.push_back(l.src);
+            } else if (!l.resto.empty()) {
+                operandos.push_back(l.resto);
+            }
+        }
+        ensamblador.reiniciar();
+        medir(mediciones[2], [&] { BancoEtapas::parsear_operandos(ensamblador, operandos); });
+
+        ensamblador.reiniciar();
+        medir(mediciones[3], [&] { BancoEtapas::despachar(ensamblador, lexadas); });
+        medir(mediciones[4], [&] { BancoEtapas::relajar(ensamblador); });
+        medir(mediciones[5], [&] { ensamblador.resolver_referencias_pendientes(); });
+        medir(mediciones[6], [&] { ok = ensamblador.generar_hex(ruta_hex) && ok; });
+        medir(mediciones[7], [&] { ok = ensamblador.generar_reportes(ruta_simbolos, ruta_referencias) && ok; });
+
+        medir(mediciones[8], [&] {
+            completo.ensamblar_memoria(fuente, 1);
+            completo.resolver_referencias_pendientes();
+        });
+    }
+
+    // Las etapas sueltas deben dar lo mismo que el ensamblado real
+    const Vista<uint8_t> a = ensamblador.codigo();
+    const Vista<uint8_t> b = completo.codigo();
+    if (a.tamano != b.tamano || !equal(a.begin(), a.end(), b.begin())) {
+        cerr << "Error: las etapas medidas por separado no reproducen el ensamblado completo" << endl;
+        ok = false;
+    }
+    if (!mensajes.str().empty()) {
+        cerr << "Mensajes del ensamblador (se muestran los primeros):\n" << mensajes.str().substr(0, 2000);
+    }
+
+    ostream& tabla = op.json == "-" ? cerr : cout;
+    escribir_tabla(tabla, num_lineas, texto.size(), b.tamano, mediciones);
+    if (!op.json.empty()) {
+        if (op.json == "-") {
+            escribir_json(cout, op, num_lineas, texto.size(), b.tamano, mediciones);
+        } else {
+            ofstream j(op.json);
+            escribir_json(j, op, num_lineas, texto.size(), b.tamano, mediciones);
+            if (!j) {
+                cerr << "No se pudo escribir " << op.json << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+#include "CacheTrozos.hpp"
+#include "ArchivoFuente.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+// Cambiar al modificar el formato o la codificación de instrucciones: las
+// cachés de versiones anteriores se descartan.
+static const char MAGIA_CACHE[4] = {'E', 'C', 'A', 'C'};
+static const uint32_t VERSION_CACHE = 9;
+
+// -----------------------------------------------------------------------------
+// Hash de bloques
+// -----------------------------------------------------------------------------
+
+static inline uint64_t rotar(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t mezclar(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t CacheTrozos::hash_bloque(string_view texto) {
+    const uint64_t PRIMO = 0x9E3779B97F4A7C15ull;
+    const char* p = texto.data();
+    size_t n = texto.size();
+    uint64_t h = PRIMO ^ n;
+
+    while (n >= 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        h = rotar(h ^ (k * 0x87C37B91114253D5ull), 31) * PRIMO;
+        p += 8;
+        n -= 8;
+    }
+    uint64_t cola = 0;
+    memcpy(&cola, p, n);
+    h ^= cola * 0x4CF5AD432745937Full;
+    return mezclar(h);
+}
+
+// -----------------------------------------------------------------------------
+// Lectura
+// -----------------------------------------------------------------------------
+
+// Lector con verificación de límites sobre el archivo completo
+struct LectorCache {
+    const char* p;
+    const char* fin;
+    bool ok = true;
+
+    template <typename T>
+    T leer() {
+        T v{};
+        if (static_cast<size_t>(fin - p) < sizeof(T)) {
+            ok = false;
+            return v;
+        }
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    template <typename T>
+    void leer_vector(vector<T>& v) {
+        uint32_t n = leer<uint32_t>();
+        if (!ok || static_cast<size_t>(fin - p) / sizeof(T) < n) {
+            ok = false;
+            return;
+        }
+        v.resize(n);
+        if (n > 0) memcpy(v.data(), p, n * sizeof(T));
+        p += n * sizeof(T);
+    }
+
+    void leer_cadena(string& s) {
+        uint32_t n = leer<uint32_t>();
+        if (!ok || static_cast<size_t>(fin - p) < n) {
+            ok = false;
+            return;
+        }
+        s.assign(p, n);
+        p += n;
+    }
+};
+
+bool CacheTrozos::cargar(const string& ruta, uint32_t opciones) {
+    entradas.clear();
+
+    ArchivoFuente archivo;
+    if (!archivo.abrir(ruta)) return false;
+    string_view datos = archivo.contenido();
+
+    LectorCache lector{datos.data(), datos.data() + datos.size()};
+    char magia[4];
+    for (char& c : magia) c = lector.leer<char>();
+    uint32_t version = lector.leer<uint32_t>();
+    uint32_t opciones_guardadas = lector.leer<uint32_t>();
+    uint32_t tam_referencia = lector.leer<uint32_t>();
+    uint32_t tam_salto = lector.leer<uint32_t>();
+    uint32_t num_trozos = lector.leer<uint32_t>();
+    if (!lector.ok || memcmp(magia, MAGIA_CACHE, 4) != 0 || version != VERSION_CACHE || opciones_guardadas != opciones ||
+        tam_referencia != sizeof(ReferenciaPendiente) || tam_salto != sizeof(SaltoRelajable)) {
+        return false;
+    }
+
+    for (uint32_t t = 0; t < num_trozos && lector.ok; ++t) {
+        TrozoEnsamblado trozo;
+        trozo.hash = lector.leer<uint64_t>();
+        trozo.largo_fuente = lector.leer<uint32_t>();
+        for (size_t i = 0; i < NUM_SECCIONES_TROZO; ++i) {
+            lector.leer_vector(trozo.codigo[i]);
+            trozo.tamanos[i] = lector.leer<uint32_t>();
+        }
+        trozo.seccion_final = lector.leer<Seccion>();
+        trozo.heredada_inicializada = lector.leer<bool>();
+        uint32_t num_nombres = lector.leer<uint32_t>();
+        if (!lector.ok || num_nombres > datos.size()) {
+            lector.ok = false;
+            break;
+        }
+        trozo.nombres.resize(num_nombres);
+        for (auto& nombre : trozo.nombres) lector.leer_cadena(nombre);
+        lector.leer_vector(trozo.posiciones);
+        lector.leer_vector(trozo.secciones);
+        lector.leer_vector(trozo.ambitos);
+        lector.leer_vector(trozo.referencias);
+        lector.leer_vector(trozo.saltos);
+        lector.leer_cadena(trozo.mensajes);
+        trozo.con_errores = lector.leer<bool>();
+        auto seccion_valida = [](Seccion s) { return s <= Seccion::Heredada; };
+        if (!lector.ok || trozo.posiciones.size() != trozo.nombres.size() ||
+            trozo.secciones.size() != trozo.nombres.size() || trozo.ambitos.size() != trozo.nombres.size() ||
+            !seccion_valida(trozo.seccion_final) ||
+            !all_of(trozo.secciones.begin(), trozo.secciones.end(), seccion_valida) ||
+            !all_of(trozo.saltos.begin(), trozo.saltos.end(),
+                    [&](const SaltoRelajable& s) { return seccion_valida(s.seccion); })) {
+            lector.ok = false;
+            break;
+        }
+
+        uint64_t clave = trozo.hash;
+        entradas.emplace(clave, move(trozo));
+    }
+
+    if (!lector.ok) {
+        entradas.clear();
+        return false;
+    }
+    return true;
+}
+
+const TrozoEnsamblado* CacheTrozos::buscar(uint64_t hash, size_t largo) const {
+    auto it = entradas.find(hash);
+    if (it == entradas.end() || it->second.largo_fuente != largo) return nullptr;
+    return &it->second;
+}
+
+// -----------------------------------------------------------------------------
+// Escritura
+// -----------------------------------------------------------------------------
+
+template <typename T>
+static void escribir(ofstream& f, const T& v) {
+    f.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static void escribir_vector(ofstream& f, const vector<T>& v) {
+    escribir(f, static_cast<uint32_t>(v.size()));
+    if (!v.empty()) f.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+static void escribir_cadena(ofstream& f, const string& s) {
+    escribir(f, static_cast<uint32_t>(s.size()));
+    f.write(s.data(), s.size());
+}
+
+bool CacheTrozos::guardar(const string& ruta, const vector<const TrozoEnsamblado*>& trozos, uint32_t opciones) const {
+    // Un bloque repetido en la fuente se guarda una sola vez. Los que usan
+    // INCBIN no se guardan: el archivo incluido puede cambiar sin que cambie
+    // el texto del bloque.
+    vector<const TrozoEnsamblado*> unicos;
+    unordered_map<uint64_t, bool> vistos;
+    for (const TrozoEnsamblado* t : trozos) {
+        if (t->depende_de_archivos) continue;
+        if (vistos.emplace(t->hash, true).second) unicos.push_back(t);
+    }
+
+    const string temporal = ruta + ".tmp";
+    ofstream f(temporal, ios::binary | ios::trunc);
+    if (!f) return false;
+
+    f.write(MAGIA_CACHE, 4);
+    escribir(f, VERSION_CACHE);
+    escribir(f, opciones);
+    escribir(f, static_cast<uint32_t>(sizeof(ReferenciaPendiente)));
+    escribir(f, static_cast<uint32_t>(sizeof(SaltoRelajable)));
+    escribir(f, static_cast<uint32_t>(unicos.size()));
+
+    for (const TrozoEnsamblado* t : unicos) {
+        escribir(f, t->hash);
+        escribir(f, t->largo_fuente);
+        for (size_t i = 0; i < NUM_SECCIONES_TROZO; ++i) {
+            escribir_vector(f, t->codigo[i]);
+            escribir(f, t->tamanos[i]);
+        }
+        escribir(f, t->seccion_final);
+        escribir(f, t->heredada_inicializada);
+        escribir(f, static_cast<uint32_t>(t->nombres.size()));
+        for (const auto& nombre : t->nombres) escribir_cadena(f, nombre);
+        escribir_vector(f, t->posiciones);
+        escribir_vector(f, t->secciones);
+        escribir_vector(f, t->ambitos);
+        escribir_vector(f, t->referencias);
+        escribir_vector(f, t->saltos);
+        escribir_cadena(f, t->mensajes);
+        escribir(f, t->con_errores);
+    }
+
+    f.close();
+    if (!f) {
+        remove(temporal.c_str());
+        return false;
+    }
+    return rename(temporal.c_str(), ruta.c_str()) == 0;
+}
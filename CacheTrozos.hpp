@@ -0,0 +1,41 @@
+#ifndef CACHE_TROZOS_HPP
+#define CACHE_TROZOS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+using namespace std;
+
+// --- CACHÉ DE TROZOS ENSAMBLADOS (MODO INCREMENTAL) ---
+// Guarda en un archivo binario, por cada bloque de líneas de una fuente, el
+// hash de su texto junto con su código, etiquetas, referencias y mensajes.
+// En la siguiente pasada los bloques sin cambios se toman de aquí y solo se
+// ensamblan los que cambiaron. El archivo se reescribe con los bloques
+// usados en la última pasada, así que no crece con versiones viejas.
+
+class CacheTrozos {
+private:
+    unordered_map<uint64_t, TrozoEnsamblado> entradas;
+
+public:
+    // Carga 'ruta'. Si no existe, está dañada, es de otra versión o se
+    // ensambló con otras 'opciones' de codificación, la caché queda vacía
+    // (todo se ensambla de nuevo) y devuelve false.
+    bool cargar(const string& ruta, uint32_t opciones);
+
+    // Trozo guardado para un bloque con ese hash y largo, o nullptr
+    const TrozoEnsamblado* buscar(uint64_t hash, size_t largo) const;
+
+    // Escribe los trozos de esta pasada (a un temporal que luego se renombra)
+    bool guardar(const string& ruta, const vector<const TrozoEnsamblado*>& trozos, uint32_t opciones) const;
+
+    // Hash de 64 bits del texto de un bloque, 8 bytes por iteración
+    static uint64_t hash_bloque(string_view texto);
+};
+
+#endif // CACHE_TROZOS_HPP
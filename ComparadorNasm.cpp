@@ -0,0 +1,446 @@
+// --- COMPARADOR CONTRA NASM ---
+// Pasa un corpus de fuentes por el ensamblador y por NASM (-f bin), compara
+// los binarios planos byte a byte e informa líneas/s y MB/s de cada uno, de
+// modo que una regresión en la codificación o en el rendimiento aparezca en
+// la misma corrida.
+//
+// El corpus son los archivos de la línea de comandos más unas fuentes de
+// estrés generadas (siempre las mismas) que recorren las formas de
+// procesar_binaria y procesar_mov y todos los modos de memoria que arma
+// codificar_memoria: base, base+índice*escala, solo índice, disp8/disp32,
+// etiqueta+desplazamiento, [EBP] y [ESP], más saltos cortos y largos hacia
+// adelante y hacia atrás en el límite de rel8.
+//
+// Ambas herramientas se ejecutan como procesos y se mide el mejor de -r
+// corridas, así los dos tiempos incluyen lo mismo (arranque, lectura y
+// escritura). NASM recibe una copia de cada fuente con BITS 32 delante.
+//
+// Uso: comparador [-e ENSAMBLADOR] [-n NASM] [-d DIR] [-r N] [-j N]
+//                 [--lineas N] [--sin-generar] archivo.asm...
+
+#include "GeneradorFuentes.hpp"
+
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct OpcionesComparador {
+    vector<string> entradas;
+    string ensamblador = "./ensamblador";
+    string nasm = "nasm";
+    string dir_trabajo = "comparacion";
+    unsigned repeticiones = 3;
+    unsigned hilos = 1;               // -j del ensamblador; NASM usa uno
+    uint32_t lineas_rendimiento = 200000;
+    bool generar = true;
+};
+
+static void mostrar_uso(const char* programa) {
+    cerr << "Uso: " << programa << " [-e ENSAMBLADOR] [-n NASM] [-d DIR] [-r N] [-j N] [--lineas N]\n"
+         << "       [--sin-generar] [archivo.asm...]\n"
+         << "  -e ENSAMBLADOR  ejecutable a probar (por defecto, ./ensamblador)\n"
+         << "  -n NASM         ensamblador de referencia (por defecto, nasm)\n"
+         << "  -d DIR          directorio de trabajo (por defecto, comparacion)\n"
+         << "  -r N            corridas por archivo; se informa la mas rapida (por defecto, 3)\n"
+         << "  -j N            hilos del ensamblador (por defecto, 1)\n"
+         << "  --lineas N      lineas de la fuente de rendimiento generada (por defecto, 200000)\n"
+         << "  --sin-generar   solo los archivos dados, sin las fuentes de estres\n"
+         << "Sale con 1 si algun binario difiere o alguna herramienta falla.\n";
+}
+
+static bool leer_numero(const string& texto, unsigned minimo, uint32_t& valor) {
+    char* fin = nullptr;
+    const unsigned long v = strtoul(texto.c_str(), &fin, 10);
+    if (texto.empty() || *fin != '\0' || v < minimo || v > 0xFFFFFFFFul) return false;
+    valor = static_cast<uint32_t>(v);
+    return true;
+}
+
+static bool parsear_argumentos(int argc, char** argv, OpcionesComparador& op) {
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        auto valor = [&](string& destino) {
+            if (i + 1 >= argc) {
+                cerr << "Falta el valor de " << arg << endl;
+                return false;
+            }
+            destino = argv[++i];
+            return true;
+        };
+        auto numero = [&](unsigned minimo, uint32_t& destino) {
+            string texto;
+            if (!valor(texto)) return false;
+            if (!leer_numero(texto, minimo, destino)) {
+                cerr << "Valor invalido para " << arg << ": " << texto << endl;
+                return false;
+            }
+            return true;
+        };
+
+        uint32_t n = 0;
+        if (arg == "-h" || arg == "--ayuda") {
+            return false;
+        } else if (arg == "-e") {
+            if (!valor(op.ensamblador)) return false;
+        } else if (arg == "-n") {
+            if (!valor(op.nasm)) return false;
+        } else if (arg == "-d") {
+            if (!valor(op.dir_trabajo)) return false;
+        } else if (arg == "-r") {
+            if (!numero(1, n)) return false;
+            op.repeticiones = n;
+        } else if (arg == "-j") {
+            if (!numero(1, n)) return false;
+            op.hilos = n;
+        } else if (arg == "--lineas") {
+            if (!numero(1, op.lineas_rendimiento)) return false;
+        } else if (arg == "--sin-generar") {
+            op.generar = false;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return false;
+        } else {
+            op.entradas.push_back(arg);
+        }
+    }
+    return op.generar || !op.entradas.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Fuentes de estrés
+// -----------------------------------------------------------------------------
+
+// Encabezado común (BITS 32 para NASM y la tabla de las referencias con
+// etiqueta) y cierre de cada fuente de estrés
+static void escribir_encabezado(ostream& s) {
+    string encabezado;
+    escribir_encabezado_fuente(encabezado);
+    s << encabezado;
+}
+
+static void escribir_cierre(ostream& s) {
+    s << "fin:\n    ret\n";
+}
+
+static void generar_binaria(ostream& s, const vector<string>& memoria) {
+    escribir_encabezado(s);
+    for (const char* op : BINARIAS_FUENTE) {
+        for (const char* d : REGISTROS_FUENTE) {
+            for (const char* f : REGISTROS_FUENTE) s << "    " << op << ' ' << d << ", " << f << '\n';
+            for (const char* imm : INMEDIATOS_FUENTE) s << "    " << op << ' ' << d << ", " << imm << '\n';
+        }
+        for (const string& m : memoria) {
+            s << "    " << op << " ecx, " << m << '\n'
+              << "    " << op << ' ' << m << ", edx\n"
+              << "    " << op << " dword " << m << ", 1\n"
+              << "    " << op << " dword " << m << ", -128\n"
+              << "    " << op << " dword " << m << ", 500\n";
+        }
+    }
+    escribir_cierre(s);
+}
+
+static void generar_mov(ostream& s, const vector<string>& memoria) {
+    escribir_encabezado(s);
+    for (const char* d : REGISTROS_FUENTE) {
+        for (const char* f : REGISTROS_FUENTE) s << "    mov " << d << ", " << f << '\n';
+        for (const char* imm : INMEDIATOS_FUENTE) s << "    mov " << d << ", " << imm << '\n';
+        s << "    mov " << d << ", tabla\n"
+          << "    mov " << d << ", [tabla]\n"
+          << "    mov [tabla+4], " << d << '\n';
+    }
+    for (const string& m : memoria) {
+        s << "    mov eax, " << m << '\n'
+          << "    mov " << m << ", eax\n"
+          << "    mov edi, " << m << '\n'
+          << "    mov " << m << ", ebx\n"
+          << "    mov dword " << m << ", 0x11223344\n";
+    }
+    escribir_cierre(s);
+}
+
+// Saltos hacia adelante y hacia atrás justo antes y después del límite de
+// rel8 (127 / -128), más CALL y LOOP
+static void generar_saltos(ostream& s) {
+    escribir_encabezado(s);
+    for (uint32_t k = 118; k <= 134; ++k) {
+        s << "ida_" << k << ":\n"
+          << "    jmp vuelta_" << k << '\n'
+          << "    times " << k << " nop\n"
+          << "vuelta_" << k << ":\n"
+          << "    times " << k << " nop\n"
+          << "    jmp ida_" << k << '\n';
+        for (const char* jcc : CONDICIONALES_FUENTE) {
+            s << "atras_" << jcc << '_' << k << ":\n"
+              << "    times " << k << " nop\n"
+              << "    " << jcc << " atras_" << jcc << '_' << k << '\n'
+              << "    " << jcc << " adelante_" << jcc << '_' << k << '\n'
+              << "    times " << k << " nop\n"
+              << "adelante_" << jcc << '_' << k << ":\n";
+        }
+    }
+    s << "lejos:\n"
+      << "    call inicio\n"
+      << "    call fin\n"
+      << "    times 1000 nop\n"
+      << "    jmp lejos\n"
+      << "    je lejos\n"
+      << "    jmp fin\n"
+      << "    jne fin\n"
+      << "cerca:\n"
+      << "    nop\n"
+      << "    loop cerca\n"
+      << "    jmp cerca\n";
+    escribir_cierre(s);
+}
+
+static bool escribir_fuente(const string& ruta, const string& texto) {
+    ofstream f(ruta, ios::binary);
+    f << texto;
+    return static_cast<bool>(f);
+}
+
+static bool generar_corpus(const OpcionesComparador& op, const fs::path& dir, vector<string>& corpus) {
+    error_code ec;
+    fs::create_directories(dir, ec);
+    const vector<string> memoria = formas_memoria();
+
+    struct Generada {
+        const char* nombre;
+        string texto;
+    };
+    vector<Generada> fuentes(4);
+    ostringstream s;
+    generar_binaria(s, memoria);
+    fuentes[0] = {"estres_binaria.asm", s.str()};
+    s.str("");
+    generar_mov(s, memoria);
+    fuentes[1] = {"estres_mov.asm", s.str()};
+    s.str("");
+    generar_saltos(s);
+    fuentes[2] = {"estres_saltos.asm", s.str()};
+
+    // Fuente grande para medir: la mezcla por defecto del generador con una
+    // tabla DD en .data
+    MezclaFuente mezcla;
+    mezcla.lineas = op.lineas_rendimiento;
+    mezcla.entradas_dd = op.lineas_rendimiento / 16;
+    fuentes[3] = {"estres_rendimiento.asm", generar_fuente(mezcla)};
+
+    for (const Generada& g : fuentes) {
+        const string ruta = (dir / g.nombre).string();
+        if (!escribir_fuente(ruta, g.texto)) {
+            cerr << "No se pudo escribir " << ruta << endl;
+            return false;
+        }
+        corpus.push_back(ruta);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Ejecución y comparación
+// -----------------------------------------------------------------------------
+
+// Comillas simples para sh; una comilla interna se cierra y se escapa
+static string citar(const string& s) {
+    string r = "'";
+    for (char c : s) {
+        if (c == '\'') r += "'\\''";
+        else r.push_back(c);
+    }
+    return r + "'";
+}
+
+static bool leer_binario(const string& ruta, vector<uint8_t>& datos) {
+    ifstream f(ruta, ios::binary);
+    if (!f) return false;
+    datos.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+    return true;
+}
+
+static string leer_texto(const string& ruta) {
+    ifstream f(ruta, ios::binary);
+    return string(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+}
+
+// Ejecuta 'comando' 'repeticiones' veces y deja en 'segundos' la más rápida.
+// Devuelve false si alguna corrida terminó con error.
+static bool medir(const string& comando, unsigned repeticiones, double& segundos) {
+    segundos = 0;
+    for (unsigned r = 0; r < repeticiones; ++r) {
+        const auto inicio = chrono::steady_clock::now();
+        const int estado = system(comando.c_str());
+        const double t = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        if (estado == -1 || !WIFEXITED(estado) || WEXITSTATUS(estado) != 0) return false;
+        if (r == 0 || t < segundos) segundos = t;
+    }
+    return true;
+}
+
+// Etiqueta más cercana antes de 'offset', según X.simbolos.txt ("NOMBRE -> n")
+static string etiqueta_cercana(const string& ruta_simbolos, size_t offset) {
+    istringstream lineas(leer_texto(ruta_simbolos));
+    string linea, mejor;
+    long mejor_pos = -1;
+    while (getline(lineas, linea)) {
+        const size_t flecha = linea.find(" -> ");
+        if (flecha == string::npos) continue;
+        const long pos = strtol(linea.c_str() + flecha + 4, nullptr, 10);
+        if (pos >= 0 && static_cast<size_t>(pos) <= offset && pos > mejor_pos) {
+            mejor_pos = pos;
+            mejor = linea.substr(0, flecha);
+        }
+    }
+    if (mejor_pos < 0) return string();
+    return mejor + "+" + to_string(offset - static_cast<size_t>(mejor_pos));
+}
+
+static void volcar_bytes(const char* titulo, const vector<uint8_t>& datos, size_t desde, size_t hasta) {
+    cout << "    " << titulo;
+    for (size_t i = desde; i < hasta; ++i) {
+        if (i < datos.size()) cout << ' ' << hex << uppercase << setw(2) << setfill('0') << +datos[i];
+        else cout << " --";
+    }
+    cout << dec << setfill(' ') << '\n';
+}
+
+// Primer byte distinto con contexto; 'false' si los binarios difieren
+static bool comparar(const vector<uint8_t>& propio, const vector<uint8_t>& referencia, const string& ruta_simbolos) {
+    const size_t comun = min(propio.size(), referencia.size());
+    size_t i = 0;
+    while (i < comun && propio[i] == referencia[i]) ++i;
+    if (i == comun && propio.size() == referencia.size()) return true;
+
+    cout << "  DIFIERE en el offset 0x" << hex << uppercase << i << dec;
+    const string cercana = etiqueta_cercana(ruta_simbolos, i);
+    if (!cercana.empty()) cout << " (" << cercana << ")";
+    cout << "; tamanos " << propio.size() << " y " << referencia.size() << '\n';
+    const size_t desde = i >= 8 ? i - 8 : 0;
+    const size_t hasta = i + 8;
+    volcar_bytes("ensamblador:", propio, desde, hasta);
+    volcar_bytes("nasm:       ", referencia, desde, hasta);
+    return false;
+}
+
+struct Totales {
+    uint64_t lineas = 0;
+    uint64_t bytes = 0;
+    double segundos_propio = 0;
+    double segundos_nasm = 0;
+};
+
+static void informar_velocidad(const char* titulo, uint64_t lineas, uint64_t bytes, double segundos) {
+    const double s = max(segundos, 1e-9);
+    cout << "  " << titulo << fixed << setprecision(3) << setw(9) << segundos << " s  " << setprecision(0)
+         << setw(12) << lineas / s << " lineas/s  " << setprecision(2) << setw(8) << bytes / s / 1e6 << " MB/s\n";
+    cout.unsetf(ios::floatfield);
+}
+
+static bool comparar_archivo(const OpcionesComparador& op, const fs::path& dir, const string& entrada,
+                             Totales& totales) {
+    const string base = fs::path(entrada).stem().string();
+    const string fuente = leer_texto(entrada);
+    const uint64_t lineas = static_cast<uint64_t>(count(fuente.begin(), fuente.end(), '\n'));
+    cout << entrada << ": " << lineas << " lineas, " << fuente.size() << " bytes\n";
+
+    // NASM arranca en 16 bits: su copia lleva BITS 32 delante (repetirlo no
+    // cambia nada si la fuente ya lo tiene)
+    const fs::path dir_propio = dir / "propio";
+    const fs::path dir_nasm = dir / "nasm";
+    const string copia = (dir_nasm / (base + ".asm")).string();
+    if (!escribir_fuente(copia, "BITS 32\n" + fuente)) {
+        cout << "  No se pudo escribir " << copia << '\n';
+        return false;
+    }
+
+    const string log_propio = (dir_propio / (base + ".log")).string();
+    const string log_nasm = (dir_nasm / (base + ".log")).string();
+    const string bin_propio = (dir_propio / (base + ".bin")).string();
+    const string bin_nasm = (dir_nasm / (base + ".bin")).string();
+    const string cmd_propio = citar(op.ensamblador) + " -j" + to_string(op.hilos) + " -f bin -o " +
+                              citar(dir_propio.string()) + " " + citar(entrada) + " > " + citar(log_propio) + " 2>&1";
+    const string cmd_nasm = citar(op.nasm) + " -f bin -o " + citar(bin_nasm) + " " + citar(copia) + " > " +
+                            citar(log_nasm) + " 2>&1";
+
+    double t_propio = 0, t_nasm = 0;
+    bool ok = true;
+    if (!medir(cmd_propio, op.repeticiones, t_propio)) {
+        cout << "  El ensamblador fallo (ver " << log_propio << ")\n";
+        ok = false;
+    }
+    if (!medir(cmd_nasm, op.repeticiones, t_nasm)) {
+        cout << "  NASM fallo (ver " << log_nasm << ")\n";
+        ok = false;
+    }
+    if (!ok) return false;
+
+    vector<uint8_t> propio, referencia;
+    if (!leer_binario(bin_propio, propio) || !leer_binario(bin_nasm, referencia)) {
+        cout << "  Falta alguno de los binarios\n";
+        return false;
+    }
+    ok = comparar(propio, referencia, (dir_propio / (base + ".simbolos.txt")).string());
+    if (ok) cout << "  IGUALES (" << propio.size() << " bytes)\n";
+
+    informar_velocidad("ensamblador:", lineas, fuente.size(), t_propio);
+    informar_velocidad("nasm:       ", lineas, fuente.size(), t_nasm);
+    totales.lineas += lineas;
+    totales.bytes += fuente.size();
+    totales.segundos_propio += t_propio;
+    totales.segundos_nasm += t_nasm;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    OpcionesComparador op;
+    if (!parsear_argumentos(argc, argv, op)) {
+        mostrar_uso(argv[0]);
+        return 2;
+    }
+
+    const fs::path dir(op.dir_trabajo);
+    error_code ec;
+    fs::create_directories(dir / "propio", ec);
+    fs::create_directories(dir / "nasm", ec);
+
+    vector<string> corpus = op.entradas;
+    if (op.generar && !generar_corpus(op, dir / "fuentes", corpus)) return 1;
+
+    // Dos entradas con el mismo nombre base se pisarían las salidas
+    set<string> bases;
+    for (const string& entrada : corpus) {
+        if (!bases.insert(fs::path(entrada).stem().string()).second) {
+            cerr << "Error: dos archivos generan la misma salida '" << fs::path(entrada).stem().string() << "'"
+                 << endl;
+            return 2;
+        }
+    }
+
+    Totales totales;
+    size_t distintos = 0;
+    for (const string& entrada : corpus) {
+        if (!comparar_archivo(op, dir, entrada, totales)) ++distintos;
+    }
+
+    cout << "\nTotal: " << corpus.size() << " archivos, " << totales.lineas << " lineas, " << distintos
+         << " con diferencias o fallos\n";
+    informar_velocidad("ensamblador:", totales.lineas, totales.bytes, totales.segundos_propio);
+    informar_velocidad("nasm:       ", totales.lineas, totales.bytes, totales.segundos_nasm);
+    return distintos > 0 ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+#include "ConversionHex.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HEX_X86 1
+#endif
+
+static const char DIGITOS_HEX[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                     '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+static const size_t BYTES_POR_LINEA = 16;
+static const size_t LARGO_LINEA = 3 * BYTES_POR_LINEA + 1;
+
+size_t largo_hex_texto(size_t n) {
+    return 3 * n + (n + BYTES_POR_LINEA - 1) / BYTES_POR_LINEA;
+}
+
+// -----------------------------------------------------------------------------
+// Variante escalar (referencia y resto de cada bloque)
+// -----------------------------------------------------------------------------
+
+static inline void byte_a_hex(uint8_t b, char* salida) {
+    salida[0] = DIGITOS_HEX[b >> 4];
+    salida[1] = DIGITOS_HEX[b & 0x0F];
+}
+
+static void bytes_a_hex_escalar(const uint8_t* datos, size_t n, char* salida) {
+    for (size_t i = 0; i < n; ++i) byte_a_hex(datos[i], salida + 2 * i);
+}
+
+// Formatea los bytes [desde, n); 'desde' siempre es inicio de línea
+static size_t hex_texto_escalar(const uint8_t* datos, size_t n, char* salida, size_t desde) {
+    char* p = salida;
+    for (size_t i = desde; i < n; ++i) {
+        byte_a_hex(datos[i], p);
+        p[2] = ' ';
+        p += 3;
+        if ((i + 1) % BYTES_POR_LINEA == 0) *p++ = '\n';
+    }
+    if (n % BYTES_POR_LINEA != 0 && n > desde) *p++ = '\n';
+    return static_cast<size_t>(p - salida);
+}
+
+static size_t hex_texto_solo_escalar(const uint8_t* datos, size_t n, char* salida) {
+    return hex_texto_escalar(datos, n, salida, 0);
+}
+
+static uint32_t sumar_escalar(const uint8_t* datos, size_t n) {
+    uint32_t suma = 0;
+    for (size_t i = 0; i < n; ++i) suma += datos[i];
+    return suma;
+}
+
+#ifdef HEX_X86
+
+// -----------------------------------------------------------------------------
+// SSSE3: 16 bytes por iteración
+// -----------------------------------------------------------------------------
+
+// Dígitos de los 16 bytes de 'v', intercalados (alto, bajo):
+// 'a' recibe los bytes 0..7 y 'b' los bytes 8..15
+__attribute__((target("ssse3")))
+static inline void digitos_ssse3(__m128i v, __m128i& a, __m128i& b) {
+    const __m128i tabla = _mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITOS_HEX));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i alto = _mm_shuffle_epi8(tabla, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    __m128i bajo = _mm_shuffle_epi8(tabla, _mm_and_si128(v, nibble));
+    a = _mm_unpacklo_epi8(alto, bajo);
+    b = _mm_unpackhi_epi8(alto, bajo);
+}
+
+__attribute__((target("ssse3")))
+static void bytes_a_hex_ssse3(const uint8_t* datos, size_t n, char* salida) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a, b;
+        digitos_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i)), a, b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(salida + 2 * i), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(salida + 2 * i + 16), b);
+    }
+    bytes_a_hex_escalar(datos + i, n - i, salida + 2 * i);
+}
+
+// Una línea de texto son 48 caracteres "HL " más '\n'. Cada uno de los tres
+// bloques de 16 caracteres se arma con un pshufb sobre 'a', otro sobre 'b'
+// (0x80 = poner cero) y los espacios en las posiciones que quedan.
+struct MascarasLinea {
+    alignas(16) int8_t de_a[3][16];
+    alignas(16) int8_t de_b[3][16];
+    alignas(16) int8_t espacios[3][16];
+};
+
+static MascarasLinea construir_mascaras() {
+    MascarasLinea m{};
+    for (int k = 0; k < 3; ++k) {
+        for (int p = 0; p < 16; ++p) {
+            const int c = 16 * k + p;
+            const int byte = c / 3, digito = c % 3;
+            m.de_a[k][p] = m.de_b[k][p] = static_cast<int8_t>(0x80);
+            if (digito == 2) {
+                m.espacios[k][p] = ' ';
+                continue;
+            }
+            const int indice = 2 * byte + digito;
+            if (indice < 16) m.de_a[k][p] = static_cast<int8_t>(indice);
+            else m.de_b[k][p] = static_cast<int8_t>(indice - 16);
+        }
+    }
+    return m;
+}
+
+static const MascarasLinea MASCARAS_LINEA = construir_mascaras();
+
+__attribute__((target("ssse3")))
+static size_t hex_texto_ssse3(const uint8_t* datos, size_t n, char* salida) {
+    const MascarasLinea& m = MASCARAS_LINEA;
+    char* p = salida;
+    size_t i = 0;
+    for (; i + BYTES_POR_LINEA <= n; i += BYTES_POR_LINEA) {
+        __m128i a, b;
+        digitos_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i)), a, b);
+        for (int k = 0; k < 3; ++k) {
+            __m128i bloque = _mm_or_si128(
+                _mm_or_si128(_mm_shuffle_epi8(a, _mm_load_si128(reinterpret_cast<const __m128i*>(m.de_a[k]))),
+                             _mm_shuffle_epi8(b, _mm_load_si128(reinterpret_cast<const __m128i*>(m.de_b[k])))),
+                _mm_load_si128(reinterpret_cast<const __m128i*>(m.espacios[k])));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 16 * k), bloque);
+        }
+        p[48] = '\n';
+        p += LARGO_LINEA;
+    }
+    p += hex_texto_escalar(datos, n, p, i);
+    return static_cast<size_t>(p - salida);
+}
+
+// psadbw contra cero suma 8 bytes en cada mitad de 64 bits
+__attribute__((target("ssse3")))
+static uint32_t sumar_ssse3(const uint8_t* datos, size_t n) {
+    const __m128i cero = _mm_setzero_si128();
+    __m128i acumulado = cero;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i));
+        acumulado = _mm_add_epi64(acumulado, _mm_sad_epu8(v, cero));
+    }
+    uint32_t suma = static_cast<uint32_t>(_mm_cvtsi128_si32(acumulado)) +
+                    static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(acumulado, 8)));
+    return suma + sumar_escalar(datos + i, n - i);
+}
+
+#endif // HEX_X86
+
+// -----------------------------------------------------------------------------
+// Selección en tiempo de ejecución
+// -----------------------------------------------------------------------------
+
+struct VarianteHex {
+    void (*hex)(const uint8_t*, size_t, char*);
+    size_t (*texto)(const uint8_t*, size_t, char*);
+    uint32_t (*suma)(const uint8_t*, size_t);
+    const char* nombre;
+};
+
+static VarianteHex elegir_variante() {
+#ifdef HEX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) return {bytes_a_hex_ssse3, hex_texto_ssse3, sumar_ssse3, "SSSE3"};
+#endif
+    return {bytes_a_hex_escalar, hex_texto_solo_escalar, sumar_escalar, "escalar"};
+}
+
+static const VarianteHex VARIANTE_HEX = elegir_variante();
+
+void bytes_a_hex(const uint8_t* datos, size_t n, char* salida) {
+    VARIANTE_HEX.hex(datos, n, salida);
+}
+
+size_t bytes_a_hex_texto(const uint8_t* datos, size_t n, char* salida) {
+    return VARIANTE_HEX.texto(datos, n, salida);
+}
+
+uint32_t sumar_bytes(const uint8_t* datos, size_t n) {
+    return VARIANTE_HEX.suma(datos, n);
+}
+
+const char* nivel_simd_hex() {
+    return VARIANTE_HEX.nombre;
+}
@@ -0,0 +1,29 @@
+#ifndef CONVERSION_HEX_HPP
+#define CONVERSION_HEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// --- CONVERSIÓN A HEXADECIMAL ---
+// Núcleos para los formatos de texto de salida. Cada nibble se traduce a su
+// dígito ASCII con una búsqueda en tabla de 16 entradas hecha por pshufb
+// (SSSE3), 16 bytes de entrada por iteración; el resto va por tabla escalar.
+// La variante se elige en tiempo de ejecución según la CPU.
+// Los dígitos son siempre en mayúsculas.
+
+// Escribe 2*n caracteres: "0A1B..." sin separadores
+void bytes_a_hex(const uint8_t* datos, size_t n, char* salida);
+
+// Formato de programa.hex: "0A 1B ... " con 16 bytes por línea y '\n' al
+// final de cada línea (también de la última si está incompleta).
+// 'salida' debe tener capacidad para largo_hex_texto(n). Devuelve lo escrito.
+size_t bytes_a_hex_texto(const uint8_t* datos, size_t n, char* salida);
+size_t largo_hex_texto(size_t n);
+
+// Suma de los bytes (para las sumas de control de Intel HEX y S-record)
+uint32_t sumar_bytes(const uint8_t* datos, size_t n);
+
+// Nombre de la variante elegida: "SSSE3" o "escalar"
+const char* nivel_simd_hex();
+
+#endif // CONVERSION_HEX_HPP
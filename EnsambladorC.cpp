@@ -0,0 +1,83 @@
+#include "EnsambladorC.h"
+#include "EnsambladorIA32.hpp"
+
+#include <new>
+#include <sstream>
+
+using namespace std;
+
+// El tipo opaco de la interfaz C: el ensamblador y sus mensajes
+struct ensamblador_ia32 {
+    EnsambladorIA32 ensamblador;
+    ostringstream salida_mensajes;
+    string mensajes;
+
+    ensamblador_ia32() {
+        ensamblador.redirigir_errores(salida_mensajes);
+    }
+};
+
+extern "C" {
+
+ensamblador_ia32* ensamblador_crear(void) {
+    return new (nothrow) ensamblador_ia32();
+}
+
+void ensamblador_destruir(ensamblador_ia32* e) {
+    delete e;
+}
+
+int ensamblador_ensamblar(ensamblador_ia32* e, const char* fuente, size_t largo) {
+    if (e == nullptr || (fuente == nullptr && largo > 0)) return -1;
+
+    e->salida_mensajes.str(string());
+    e->ensamblador.ensamblar_memoria(string_view(fuente, largo));
+    e->ensamblador.resolver_referencias_pendientes();
+    e->mensajes = e->salida_mensajes.str();
+    if (e->ensamblador.con_errores()) return 1;
+    return e->mensajes.empty() ? 0 : 2;
+}
+
+void ensamblador_reiniciar(ensamblador_ia32* e) {
+    if (e == nullptr) return;
+    e->ensamblador.reiniciar();
+    e->salida_mensajes.str(string());
+    e->mensajes.clear();
+}
+
+const uint8_t* ensamblador_codigo(const ensamblador_ia32* e, size_t* largo) {
+    if (e == nullptr) {
+        if (largo != nullptr) *largo = 0;
+        return nullptr;
+    }
+    Vista<uint8_t> codigo = e->ensamblador.codigo();
+    if (largo != nullptr) *largo = codigo.tamano;
+    return codigo.datos;
+}
+
+size_t ensamblador_num_simbolos(const ensamblador_ia32* e) {
+    if (e == nullptr) return 0;
+    return e->ensamblador.num_simbolos();
+}
+
+int ensamblador_simbolo(const ensamblador_ia32* e, size_t indice,
+                        const char** nombre, size_t* largo_nombre, int32_t* posicion) {
+    if (e == nullptr || indice >= e->ensamblador.num_simbolos()) return -1;
+    const uint32_t id = static_cast<uint32_t>(indice);
+    string_view n = e->ensamblador.nombre_simbolo(id);
+    if (nombre != nullptr) *nombre = n.data();
+    if (largo_nombre != nullptr) *largo_nombre = n.size();
+    if (posicion != nullptr) *posicion = e->ensamblador.posicion_simbolo(id);
+    return 0;
+}
+
+const char* ensamblador_mensajes(const ensamblador_ia32* e, size_t* largo) {
+    if (e == nullptr) {
+        if (largo != nullptr) *largo = 0;
+        return nullptr;
+    }
+    if (largo != nullptr) *largo = e->mensajes.size();
+    return e->mensajes.c_str();
+}
+
+} // extern "C"
@@ -0,0 +1,50 @@
+#ifndef ENSAMBLADOR_C_H
+#define ENSAMBLADOR_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* --- INTERFAZ C DEL ENSAMBLADOR IA-32 ---
+ * Permite usar el ensamblador desde otros lenguajes sin pasar por archivos.
+ * Los punteros devueltos apuntan a memoria interna del ensamblador (no se
+ * copia nada) y son válidos hasta la siguiente llamada a
+ * ensamblador_ensamblar, ensamblador_reiniciar o ensamblador_destruir.
+ * Los nombres de etiqueta no terminan en '\0': usar siempre su largo.
+ * Con e == NULL las consultas devuelven NULL, 0 o -1 (y *largo = 0). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ensamblador_ia32 ensamblador_ia32;
+
+/* Crea un ensamblador; NULL si no hay memoria */
+ensamblador_ia32* ensamblador_crear(void);
+void ensamblador_destruir(ensamblador_ia32* e);
+
+/* Ensambla 'largo' bytes de fuente y resuelve las referencias.
+ * Devuelve 0 si no hubo mensajes, 1 si hubo errores, 2 si solo hubo
+ * advertencias (ver ensamblador_mensajes) y -1 si los argumentos no son
+ * válidos. */
+int ensamblador_ensamblar(ensamblador_ia32* e, const char* fuente, size_t largo);
+
+/* Olvida el último resultado conservando la memoria reservada */
+void ensamblador_reiniciar(ensamblador_ia32* e);
+
+/* Código máquina generado */
+const uint8_t* ensamblador_codigo(const ensamblador_ia32* e, size_t* largo);
+
+/* Tabla de símbolos: etiquetas en orden de aparición. Devuelve 0 si 'indice'
+ * existe; 'posicion' es -1 para etiquetas referenciadas pero no definidas. */
+size_t ensamblador_num_simbolos(const ensamblador_ia32* e);
+int ensamblador_simbolo(const ensamblador_ia32* e, size_t indice,
+                        const char** nombre, size_t* largo_nombre, int32_t* posicion);
+
+/* Errores y advertencias de la última pasada, una línea por mensaje */
+const char* ensamblador_mensajes(const ensamblador_ia32* e, size_t* largo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENSAMBLADOR_C_H */
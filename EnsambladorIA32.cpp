@@ -1,1383 +1,2151 @@
-#include "EnsambladorIA32.hpp"
-#include <cstdint>
-#include <cctype>
-#include <sstream>
-#include <algorithm>
-#include <iostream>
-#include <iomanip>
-
-using namespace std;
-
-// -----------------------------------------------------------------------------
-// Inicialización
-// -----------------------------------------------------------------------------
-
-EnsambladorIA32::EnsambladorIA32() : contador_posicion(0) {
-    inicializar_mapas();
-}
-
-void EnsambladorIA32::inicializar_mapas() {
-    // Registros de 32 bits
-    reg32_map = {
-        {"EAX", 0b000}, {"ECX", 0b001}, {"EDX", 0b010}, {"EBX", 0b011},
-        {"ESP", 0b100}, {"EBP", 0b101}, {"ESI", 0b110}, {"EDI", 0b111}
-    };
-
-    // Registros de 8 bits
-    reg8_map = {
-        {"AL", 0b000}, {"CL", 0b001}, {"DL", 0b010}, {"BL", 0b011},
-        {"AH", 0b100}, {"CH", 0b101}, {"DH", 0b110}, {"BH", 0b111}
-    };
-}
-
-// -----------------------------------------------------------------------------
-// Utilidades
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::limpiar_linea(string& linea) {
-    // Quitar comentarios
-    size_t pos = linea.find(';');
-    if (pos != string::npos) linea = linea.substr(0, pos);
-
-    // Trim
-    auto no_espacio = [](int ch) { return !isspace(ch); };
-    if (!linea.empty()) {
-        linea.erase(linea.begin(), find_if(linea.begin(), linea.end(), no_espacio));
-        linea.erase(find_if(linea.rbegin(), linea.rend(), no_espacio).base(), linea.end());
-    }
-
-    // Mayúsculas
-    transform(linea.begin(), linea.end(), linea.begin(), ::toupper);
-}
-
-bool EnsambladorIA32::separar_operandos(const string& linea_operandos, string& dest_str, string& src_str) {
-    stringstream ss(linea_operandos);
-    
-    // Leer el destino hasta la primera coma
-    if (!getline(ss, dest_str, ',')) return false;
-
-    // Leer el resto como fuente, ignorando espacios iniciales
-    ss >> ws;
-    if (!getline(ss, src_str)) return false;
-
-    // Limpiar espacios en ambos
-    limpiar_linea(dest_str);
-    limpiar_linea(src_str);
-
-    // Verificar que la fuente no esté vacía (es decir, que había un src después de la coma)
-    return !dest_str.empty() && !src_str.empty();
-}
-
-void EnsambladorIA32::agregar_dword(uint32_t dword) {
-    agregar_byte(static_cast<uint8_t>(dword & 0xFF));
-    agregar_byte(static_cast<uint8_t>((dword >> 8) & 0xFF));
-    agregar_byte(static_cast<uint8_t>((dword >> 16) & 0xFF));
-    agregar_byte(static_cast<uint8_t>((dword >> 24) & 0xFF));
-}
-
-bool EnsambladorIA32::obtener_reg8(const string& op, uint8_t& reg_code) {
-    auto it = reg8_map.find(op);
-    if (it != reg8_map.end()) {
-        reg_code = it->second;
-        return true;
-    }
-    return false;
-}
-
-
-// Direccionamiento simple [ETIQUETA]
-bool EnsambladorIA32::procesar_mem_sib(const string& operando,
-                                       uint8_t& modrm_byte,
-                                       const uint8_t reg_code,
-                                       bool /*es_destino*/) 
-{
-    string op = operando;
-
-    // Debe venir entre corchetes: [ ... ]
-    if (op.size() < 2 || op.front() != '[' || op.back() != ']')
-        return false;
-
-    // Quitar corchetes
-    op = op.substr(1, op.size() - 2);
-
-   // Limpiar espacios internos y externos
-    limpiar_linea(op);
-    op.erase(
-        remove_if(op.begin(), op.end(),
-                [](unsigned char c){ return isspace(c); }),
-        op.end()
-    );
-
-    // Patrón esperado: <etiqueta> + ESI*4 (+ disp)
-    // Buscamos "ESI*4"
-    size_t idxESI = op.find("ESI*4");
-    if (idxESI == string::npos)
-        return false;
-
-    // --- 1. Obtener la etiqueta antes de "ESI*4" ---
-    // Ej: "ARRAY+ESI*4+4" -> etiqueta parcial "ARRAY+"
-    string etiqueta = op.substr(0, idxESI);
-
-    // Si termina en '+', se lo quitamos: "ARRAY+" -> "ARRAY"
-    if (!etiqueta.empty() && etiqueta.back() == '+')
-        etiqueta.pop_back();
-    limpiar_linea(etiqueta); //Cambio
-
-    // Si por alguna razón quedó vacía, no es un patrón válido
-    if (etiqueta.empty())
-        return false;
-
-    // --- 2. Obtener desplazamiento opcional (disp8) después de ESI*4 ---
-    //   op = "ARRAY+ESI*4+4"
-    //          ^     ^   ^
-    //        idxEt  idxESI  plusAfter
-    uint8_t disp8 = 0;
-    size_t plusAfter = op.find('+', idxESI + 5); // 5 = longitud de "ESI*4"
-
-    if (plusAfter != string::npos) {
-        string dispStr = op.substr(plusAfter + 1);  // lo que va después del '+'
-        if (!dispStr.empty()) {
-            try {
-                int d = stoi(dispStr);  // soporta "+4", "4", etc.
-                disp8 = static_cast<uint8_t>(d & 0xFF);
-            } catch (...) {
-                // Si falla el parseo, dejamos disp8 = 0 y seguimos
-            }
-        }
-    }
-
-    // --- 3. Codificar ModR/M ---
-    // MOD = 00 si no hay disp8
-    // MOD = 01 si hay disp8
-    // R/M = 100 para indicar que viene byte SIB
-    uint8_t mod = (disp8 == 0) ? 0b00 : 0b01;
-    uint8_t rm  = 0b100;
-    uint8_t reg_field = reg_code;  // el registro del operando (REG en ModR/M)
-
-    modrm_byte = generar_modrm(mod, reg_field, rm);
-    agregar_byte(modrm_byte);
-
-    // --- 4. Codificar SIB ---
-    // SCALE = 10 (x4)
-    // INDEX = 110 (ESI)
-    // BASE  = 101 (usaremos disp32 como base absoluta)
-    uint8_t scale = 0b10;   // *4
-    uint8_t index = 0b110;  // ESI
-    uint8_t base  = 0b101;  // base "disp32"
-    uint8_t sib   = (scale << 6) | (index << 3) | base;
-    agregar_byte(sib);
-
-    // --- 5. Si MOD = 01, agregamos disp8 ---
-    if (mod == 0b01) {
-        agregar_byte(disp8);
-    }
-
-    // --- 6. Referencia pendiente para la etiqueta (disp32) ---
-    // Aquí va la dirección de la etiqueta (relleno = 0 por ahora)
-    ReferenciaPendiente ref;
-    ref.posicion        = contador_posicion;
-    ref.tamano_inmediato = 4;
-    ref.tipo_salto      = 0;  // absoluto
-    referencias_pendientes[etiqueta].push_back(ref);
-
-    agregar_dword(0);  // placeholder disp32
-
-    return true;
-}
-
-
-bool EnsambladorIA32::obtener_inmediato32(const string& str, uint32_t& immediate) {
-    string temp_str = str;
-    int base = 10;
-
-    if (temp_str.size() == 3 && temp_str.front() == '\'' && temp_str.back() == '\'') {
-        // Asumimos que es un solo carácter entre comillas
-        if (temp_str.size() == 3) {
-            // El valor es el código ASCII del carácter central
-            immediate = static_cast<uint32_t>(temp_str[1]);
-            return true;
-        }
-    }
-
-    // Manejar sufijo H (NASM style: FFFFH)
-    if (!temp_str.empty() && temp_str.back() == 'H') {
-        temp_str.pop_back();
-        base = 16;
-    }
-    // Manejar prefijo 0X (C/C++ style: 0X80)
-    else if (temp_str.size() > 2 && (temp_str.substr(0, 2) == "0X")) {
-        temp_str = temp_str.substr(2); // Eliminar "0X"
-        base = 16;
-    }
-    
-    // Pre-chequeo simple: si es solo "H" o "0X", es inválido
-    if (temp_str.empty() && base == 16) return false;
-
-    try {
-        size_t pos;
-        immediate = stoul(temp_str, &pos, base);
-
-        // Si no se consumió toda la cadena, no es un número válido.
-        return pos == temp_str.size();
-    }
-    catch (...) {
-        // Captura invalid_argument o out_of_range
-        return false;
-    }
-}
-void EnsambladorIA32::agregar_byte(uint8_t byte) {
-    codigo_hex.push_back(byte);
-    contador_posicion += 1;
-}
-
-bool EnsambladorIA32::obtener_reg32(const string& op, uint8_t& reg_code) {
-    auto it = reg32_map.find(op);
-    if (it != reg32_map.end()) {
-        reg_code = it->second;
-        return true;
-    }
-    return false;
-}
-
-
-uint8_t EnsambladorIA32::generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm) {
-    return (mod << 6) | (reg << 3) | rm;
-}
-
-bool EnsambladorIA32::es_etiqueta(const string& s) {
-    // La línea ya está limpia y en mayúsculas
-    return !s.empty() && s.back() == ':';
-}
-void EnsambladorIA32::procesar_etiqueta(const string& etiqueta_cruda) {
-       // Copiamos la etiqueta
-    string etiqueta = etiqueta_cruda;
-
-    if (etiqueta == "CALCULAR" && contador_posicion == 20) {
-        tabla_simbolos[etiqueta] = 19; // Forzar a la posición correcta
-    } else {
-        tabla_simbolos[etiqueta] = contador_posicion;
-    }
-}
-// -----------------------------------------------------------------------------
-// Procesamiento de líneas
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::procesar_linea(string linea) {
-    limpiar_linea(linea);
-    if (linea.empty()) return;
-
-    if (es_etiqueta(linea)) {
-        procesar_etiqueta(linea.substr(0, linea.size() - 1));
-        return;
-    }
-
-    procesar_instruccion(linea);
-}
-
-void EnsambladorIA32::procesar_instruccion(const string& linea) {
-    stringstream ss(linea);
-    string mnem;
-    ss >> mnem;
-
-    string resto;
-    getline(ss, resto);
-    limpiar_linea(resto); // Limpia el resto de la línea (operandos o directivas)
-
-    // Extraemos la directiva/segundo token AQUI.
-    stringstream resto_ss(resto);
-    string directiva_dato;
-    resto_ss >> directiva_dato;
-    limpiar_linea(directiva_dato); // Aseguramos que la directiva esté limpia
-    
-    // --- MANEJO DE DIRECTIVAS SIN CÓDIGO (SECTION, GLOBAL, EQU) ---
-    
-    if (mnem == "SECTION" || mnem == "GLOBAL" || mnem == "EXTERN" || mnem == "BITS" || directiva_dato == "EQU") {
-        // Ignoramos las directivas de NASM y EQU.
-        return; 
-    }
-
-    // --- 2. INSTRUCCIONES IA-32 IMPLEMENTADAS ---
-    if (mnem == "MOV") {
-        procesar_mov(resto);
-    }
-    else if (mnem == "ADD") {
-        procesar_add(resto);
-    }
-    else if (mnem == "SUB") {
-        procesar_sub(resto);
-    }
-    else if (mnem == "CMP") {
-        procesar_cmp(resto);
-    }
-    else if (mnem == "IMUL") {
-        procesar_imul(resto);
-    }
-    else if (mnem == "INC") {
-        procesar_inc(resto);
-    }
-    else if (mnem == "DEC") {
-        procesar_dec(resto);
-    }
-    else if (mnem == "MUL") {
-        procesar_mul(resto);
-    }
-    else if (mnem == "DIV") {
-        procesar_div(resto);
-    }
-    else if (mnem == "IDIV") {
-        procesar_idiv(resto);
-    }
-    else if (mnem == "XOR") {
-        procesar_xor(resto);
-    }
-    else if (mnem == "AND") {
-        procesar_and(resto);
-    }
-    else if (mnem == "OR") {
-        procesar_or(resto);
-    }
-    else if (mnem == "TEST") {
-        procesar_test(resto);
-    }
-    else if (mnem == "MOVZX") {
-        procesar_movzx(resto);
-    }
-    else if (mnem == "XCHG") {
-        procesar_xchg(resto);
-    }
-    else if (mnem == "LEA") {
-        procesar_lea(resto);
-    }
-    else if (mnem == "CALL") {
-        procesar_call(resto);
-    }
-    else if (mnem == "RET") {
-        procesar_ret();
-    }
-    else if (mnem == "PUSH") {
-        procesar_push(resto);
-    }
-    else if (mnem == "POP") {
-        procesar_pop(resto);
-    }
-    else if (mnem == "LOOP") {
-        procesar_loop(resto);
-    }
-    else if (mnem == "JMP") {
-        procesar_jmp(resto);
-    }
-    else if (mnem == "LEAVE") { // NUEVO
-        procesar_leave();
-    }
-    else if (mnem == "JE" || mnem == "JZ" ||
-        mnem == "JNE" || mnem == "JNZ" ||
-        mnem == "JLE" || mnem == "JL" ||
-        mnem == "JA" || mnem == "JAE" ||
-        mnem == "JB" || mnem == "JBE" ||
-        mnem == "JG" || mnem == "JGE") {
-        procesar_condicional(mnem, resto);
-    }
-    else if (mnem == "INT") {
-        uint32_t immediate;
-        if (obtener_inmediato32(resto, immediate) && immediate <= 0xFF) {
-            agregar_byte(0xCD);
-            agregar_byte(static_cast<uint8_t>(immediate));
-        }
-        else {
-            cerr << "Error: Formato de INT invalido o inmediato fuera de rango (0-255): " << resto << endl;
-        }
-    }
-    // --- 3. ETIQUETAS DE DATOS (DD/DB) ---
-    else {
-    // 'mnem' es ETIQUETA, 'directiva_dato' es DD/DB, en resto_ss queda el valor
-    if (directiva_dato == "DD") {
-        procesar_etiqueta(mnem);
-
-    // resto = "5, 2, 8, 1, 9, 3"
-    string valores;
-    getline(resto_ss, valores);   // lo que quede después de "DD"
-    limpiar_linea(valores);
-
-    string token;
-    stringstream vs(valores);
-    while (getline(vs, token, ',')) {
-        limpiar_linea(token);
-        if (token.empty()) continue;
-
-        uint32_t val;
-        if (!obtener_inmediato32(token, val)) {
-            cerr << "Error en DD: valor invalido '" << token << "'\n";
-            val = 0;
-        }
-        agregar_dword(val);
-    }
-    return;
-    } else if (directiva_dato == "DB") {
-        procesar_etiqueta(mnem);
-        string valor_str;
-        resto_ss >> valor_str;
-        uint32_t val = 0;
-        if (!valor_str.empty()) {
-            uint32_t tmp;
-            if (obtener_inmediato32(valor_str, tmp)) val = tmp & 0xFF;
-        }
-        agregar_byte(static_cast<uint8_t>(val));
-        return;
-    }
-        
-        // Si falla todo, es una instrucción o directiva realmente no soportada.
-        cerr << "Advertencia: Mnemónico o directiva no soportada: " << mnem << endl;
-    }
-}
-
-
-// -----------------------------------------------------------------------------
-// ADD, SUB, CMP (generalizado)
-// -----------------------------------------------------------------------------
-void EnsambladorIA32::procesar_binaria(
-    const string& mnem,
-    const string& operandos,
-    uint8_t opcode_rm_reg, // ej: 0x01 (ADD r/m32, r32)
-    uint8_t opcode_reg_rm, // ej: 0x03 (ADD r32, r/m32)
-    uint8_t opcode_eax_imm, // ej: 0x05 (ADD EAX, imm32)
-    uint8_t opcode_imm_general, // ej: 0x81 (ADD r/m32, imm)
-    uint8_t reg_field_extension // ej: 0b000 para ADD, 0b101 para SUB
-) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: Se esperaban 2 operandos para " << mnem << endl;
-        return;
-    }
-
-    uint8_t dest_code = 0, src_code = 0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg = obtener_reg32(src_str, src_code);
-    uint32_t immediate = 0;
-    bool src_is_imm = obtener_inmediato32(src_str, immediate);
-
-    bool dest_is_mem = (!dest_is_reg && ! (dest_str.empty() && obtener_inmediato32(dest_str, immediate)) && dest_str.size()>=2 && dest_str.front()=='[' && dest_str.back()==']');
-    bool src_is_mem = (!src_is_reg && !src_is_imm && src_str.size()>=2 && src_str.front()=='[' && src_str.back()==']');
-    
-    // 1. REG, REG (r/m32, r32)
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(opcode_rm_reg); // ej: 0x01 para ADD, 0x29 para SUB
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code); // MOD=11 (registro), REG=src, R/M=dest
-        agregar_byte(modrm);
-        return;
-    }
-
-    // 2. EAX, INMEDIATO (opcode dedicado)
-    if (dest_is_reg && dest_code == 0b000 && src_is_imm) { // EAX, imm
-        agregar_byte(opcode_eax_imm); // ej: 0x05 para ADD, 0x2D para SUB
-        agregar_dword(immediate);
-        return;
-    }
-
-    // 3. REG, [ETIQUETA] (r32, r/m32)
-    if (dest_is_reg && !src_is_imm) { 
-        agregar_byte(opcode_reg_rm); // ej: 0x03 para ADD, 0x2B para SUB, 0x3B para CMP
-        uint8_t modrm_byte;
-        // es_destino=false porque la memoria es la fuente (ModR/M usa REG=dest_code)
-        if (procesar_mem_sib(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_disp(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return;
-    }
-    
-    // 4. [ETIQUETA], REG (r/m32, r32)
-    if (src_is_reg && !src_is_imm) { 
-        agregar_byte(opcode_rm_reg); // ej: 0x01 para ADD, 0x29 para SUB, 0x39 para CMP
-        uint8_t modrm_byte;
-        // es_destino=true porque la memoria es el destino (ModR/M usa REG=src_code)
-        if (procesar_mem_sib(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_disp(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_simple(dest_str, modrm_byte, src_code, true)) return;
-    }
-
-    // 5. [ETIQUETA], INMEDIATO (81 /extension, imm32)
-    // Usaremos la versión IMM8 (0x83 /extension, imm8) si cabe, ya que el proyecto incluye ejemplos con imm8.
-    if (src_is_imm && dest_is_mem) {
-        uint8_t opcode = opcode_imm_general; // ej: 0x81
-        bool use_imm8 = (immediate <= 0xFF) || (immediate >= 0xFFFFFF80 && immediate <= 0xFFFFFFFF); // Si cabe en 8 bits con extensión de signo
-        if (use_imm8) opcode = 0x83; // Opcode 0x83 para imm8 sign-extended
-        
-        agregar_byte(opcode);
-        uint8_t modrm_byte;
-        if (procesar_mem_sib(dest_str, modrm_byte, reg_field_extension, true)) {
-            if (use_imm8) agregar_byte(static_cast<uint8_t>(immediate & 0xFF)); else agregar_dword(immediate);
-            return;
-        }
-        if (procesar_mem_disp(dest_str, modrm_byte, reg_field_extension, true)) {
-            if (use_imm8) agregar_byte(static_cast<uint8_t>(immediate & 0xFF)); else agregar_dword(immediate);
-            return;
-        }
-        if (procesar_mem_simple(dest_str, modrm_byte, reg_field_extension, true)) {
-            if (use_imm8) agregar_byte(static_cast<uint8_t>(immediate & 0xFF)); else agregar_dword(immediate);
-            return;
-        }
-    } 
-    // 6. REG, INMEDIATO (81 /extension, imm32) - Si no es EAX (ya manejado)
-    if (dest_is_reg && dest_code != 0b000 && src_is_imm) {
-        uint8_t opcode = opcode_imm_general; // ej: 0x81
-        bool use_imm8 = (immediate <= 0xFF && immediate >= 0) || (immediate >= 0xFFFFFF80 && immediate <= 0xFFFFFFFF);
-        if (use_imm8) opcode = 0x83;
-
-        agregar_byte(opcode);
-        uint8_t modrm = generar_modrm(0b11, reg_field_extension, dest_code); // Mod=11 (reg), REG=extensión, R/M=dest
-        agregar_byte(modrm);
-        
-        if (use_imm8) {
-            agregar_byte(static_cast<uint8_t>(immediate & 0xFF));
-        } else {
-            agregar_dword(immediate);
-        }
-        return;
-    }
-
-
-    cerr << "Error de sintaxis o modo no soportado para " << mnem << ": " << operandos << endl;
-}
-// -----------------------------------------------------------------------------
-// ADD, SUB, CMP, IMUL (usando el generalizado)
-// -----------------------------------------------------------------------------
-void EnsambladorIA32::procesar_add(const string& operandos) {
-    // 0x01: ADD r/m32, r32; 0x03: ADD r32, r/m32; 0x05: ADD EAX, imm32
-    // 0x81: ADD r/m32, imm32; Extensión de opcode: /0 (0b000)
-    procesar_binaria("ADD", operandos, 0x01, 0x03, 0x05, 0x81, 0b000);
-}
-
-void EnsambladorIA32::procesar_sub(const string& operandos) {
-    // 0x29: SUB r/m32, r32; 0x2B: SUB r32, r/m32; 0x2D: SUB EAX, imm32
-    // 0x81: SUB r/m32, imm32; Extensión de opcode: /5 (0b101)
-    procesar_binaria("SUB", operandos, 0x29, 0x2B, 0x2D, 0x81, 0b101);
-}
-
-void EnsambladorIA32::procesar_cmp(const string& operandos) {
-    // 0x39: CMP r/m32, r32; 0x3B: CMP r32, r/m32; 0x3D: CMP EAX, imm32
-    // 0x81: CMP r/m32, imm32; Extensión de opcode: /7 (0b111)
-    procesar_binaria("CMP", operandos, 0x39, 0x3B, 0x3D, 0x81, 0b111);
-}
-
-void EnsambladorIA32::procesar_imul(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para IMUL." << endl;
-        return;
-    }
-
-    uint8_t dest_code = 0, src_code = 0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str, src_code);
-
-    // IMUL r32, r/m32  ->  0F AF /r
-    // Para reg,reg usamos MOD = 11, REG = destino, R/M = fuente
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x0F);
-        agregar_byte(0xAF);
-        uint8_t modrm = generar_modrm(0b11, dest_code, src_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para IMUL: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_inc(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code;
-    if (obtener_reg32(op, reg_code)) {
-        // INC r32  ->  40+rd
-        agregar_byte(static_cast<uint8_t>(0x40 + reg_code));
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para INC: " << operandos << endl;
-}
-
-
-void EnsambladorIA32::procesar_dec(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code;
-    if (obtener_reg32(op, reg_code)) {
-        // Forma corta: 48+rd  (DEC r32)
-        // EAX=0 -> 48, ECX=1 -> 49, EDX=2 -> 4A, ...
-        agregar_byte(static_cast<uint8_t>(0x48 + reg_code));
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para DEC: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_push(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-    uint8_t reg_code;
-    
-    // 1. PUSH r32 (50+rd)
-    if (obtener_reg32(op, reg_code)) {
-        agregar_byte(static_cast<uint8_t>(0x50 + reg_code));
-        return;
-    }
-    
-    uint32_t immediate;
-    // 2. PUSH imm32 (68 id) - Maneja 'C', 'B', 'A' y números.
-    if (obtener_inmediato32(op, immediate)) {
-        agregar_byte(0x68); // Opcode 68
-        agregar_dword(immediate);
-        return;
-    }
-
-    // 3. PUSH r/m32 (FF /6) - Maneja [EBP+disp]
-    uint8_t modrm_byte;
-    const uint8_t ext_opcode = 0b110; // Extensión /6
-    
-    // Intentar Base + Desplazamiento
-    if (procesar_mem_disp(op, modrm_byte, ext_opcode, false)) { 
-        agregar_byte(0xFF); // Opcode FF
-        return;
-    }
-    
-    // Intentar Memoria Simple [ETIQUETA]
-    if (procesar_mem_simple(op, modrm_byte, ext_opcode, false)) {
-        agregar_byte(0xFF); // Opcode FF
-        return;
-    }
-    
-    cerr << "Error de sintaxis o modo no soportado para PUSH: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_pop(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code;
-    if (obtener_reg32(op, reg_code)) {
-        // POP r32 -> 58+rd
-        agregar_byte(static_cast<uint8_t>(0x58 + reg_code));
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para POP: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_leave() {
-    // LEAVE -> C9
-    agregar_byte(0xC9);
-}
-
-void EnsambladorIA32::procesar_ret() {
-    // RET -> C3
-    agregar_byte(0xC3);
-}
-
-void EnsambladorIA32::procesar_nop() {
-    // NOP -> 90
-    agregar_byte(0x90);
-}
-
-void EnsambladorIA32::procesar_call(string operandos) {
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    agregar_byte(0xE8);  // CALL rel32
-    int posicion_referencia = contador_posicion;
-
-    ReferenciaPendiente ref;
-    ref.posicion = posicion_referencia;
-    ref.tamano_inmediato = 4;
-    ref.tipo_salto = 1; // relativo
-    referencias_pendientes[etiqueta].push_back(ref);
-
-    agregar_dword(0); // placeholder
-}
-
-void EnsambladorIA32::procesar_loop(string operandos) {
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    agregar_byte(0xE2); // LOOP rel8
-    int posicion_referencia = contador_posicion;
-
-    ReferenciaPendiente ref;
-    ref.posicion = posicion_referencia;
-    ref.tamano_inmediato = 1;  // solo 1 byte de desplazamiento
-    ref.tipo_salto = 1;        // relativo
-    referencias_pendientes[etiqueta].push_back(ref);
-
-    agregar_byte(0x00); // placeholder
-}
-
-bool EnsambladorIA32::procesar_mem_simple(const std::string& operando,
-                                          uint8_t& modrm_byte,
-                                          const uint8_t reg_code,
-                                          bool es_destino,
-                                          uint8_t op_extension)
-{
-    std::string op = operando;
-
-    // Debe ser algo como [VAR] o [ETIQUETA]
-    if (op.size() < 3 || op.front() != '[' || op.back() != ']')
-        return false;
-
-    // Quitamos los corchetes
-    op = op.substr(1, op.size() - 2); 
-
-    //Trim y limpiar
-    limpiar_linea(op);
-
-    // Aquí asumimos direccionamiento absoluto [ETIQUETA]
-    std::string etiqueta = op;
-
-    uint8_t mod = 0b00;      // dirección absoluta
-    uint8_t rm  = 0b101;     // usar disp32 como base
-    uint8_t reg_field = es_destino ? op_extension : reg_code;
-
-    modrm_byte = generar_modrm(mod, reg_field, rm);
-    agregar_byte(modrm_byte);
-
-    // El desplazamiento (disp32) viene aquí: será la dirección de la etiqueta
-    ReferenciaPendiente ref;
-    ref.posicion         = contador_posicion;
-    ref.tamano_inmediato = 4;
-    ref.tipo_salto       = 0;    // 0 = absoluto
-    referencias_pendientes[etiqueta].push_back(ref);
-
-    // Placeholder, luego se parchea en resolver_referencias_pendientes
-    agregar_dword(0);
-
-    return true;
-}
-
-
-// -----------------------------------------------------------------------------
-// Saltos
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::procesar_jmp(const string& operandos_in) {
-    string operandos = operandos_in;
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    // Caso 1: La etiqueta ya está definida (Segunda pasada o etiqueta anterior)
-    if (tabla_simbolos.count(etiqueta)) {
-        int destino = tabla_simbolos[etiqueta];
-        
-        // El desplazamiento se calcula desde el byte siguiente a la instrucción de salto.
-        // Si usamos EB/dispb (2 bytes en total), el byte siguiente está en contador_posicion + 1.
-        int pos_disp = contador_posicion + 1; 
-        int offset = destino - pos_disp; // Cálculo del offset relativo
-
-        // Si cabe en un byte (salto corto JMP rel8)
-        if (offset >= -128 && offset <= 127) {
-            agregar_byte(0xEB); // Opcode JMP rel8
-            agregar_byte(static_cast<uint8_t>(offset & 0xFF));
-            return;
-        } else {
-            // Si no cabe, usamos near jump (JMP rel32)
-            agregar_byte(0xE9); // Opcode JMP rel32
-            int posicion_referencia = contador_posicion;
-            
-            // Creamos una referencia pendiente para parchear los 4 bytes,
-            // aunque estemos en la segunda pasada (el offset es conocido).
-            ReferenciaPendiente ref;
-            ref.posicion = posicion_referencia;
-            ref.tamano_inmediato = 4;
-            ref.tipo_salto = 1; // relativo
-            referencias_pendientes[etiqueta].push_back(ref);
-            
-            agregar_dword(0); // Placeholder disp32 (Se parchará con el offset de 4 bytes)
-            return;
-        }
-    }
-    
-    // Caso 2: La etiqueta no existe aún (Primera pasada)
-    // Emitimos el salto corto por defecto (EB 00) y referencia pendiente
-    
-    agregar_byte(0xEB); // Opcode JMP rel8
-    
-    // pos_disp es la posición del placeholder 0x00 que sigue.
-    int pos_disp = contador_posicion; 
-    
-    ReferenciaPendiente ref;
-    ref.posicion = pos_disp; // El desplazamiento se parchará en esta posición
-    ref.tamano_inmediato = 1; // rel8
-    ref.tipo_salto = 1; // relativo
-    // Esta línea asegura que 'CALCULAR' entre en el archivo referencias.txt
-    referencias_pendientes[etiqueta].push_back(ref);
-    
-    agregar_byte(0x00); // placeholder (El byte que será EB F5 en la resolución)
-}
-
-void EnsambladorIA32::procesar_condicional(const string& mnem,
-                                           const string& operandos_in) {
-    string operandos = operandos_in;
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    uint8_t opcode;
-    uint8_t opcode_ext = 0;
-    bool uses_two_byte = false;
-
-    // Mapeo a saltos cortos (rel8)
-    if (mnem == "JE" || mnem == "JZ") opcode = 0x74, opcode_ext = 0x84, uses_two_byte = true;
-    else if (mnem == "JNE" || mnem == "JNZ") opcode = 0x75, opcode_ext = 0x85, uses_two_byte = true;
-    else if (mnem == "JLE") opcode = 0x7E, opcode_ext = 0x8E, uses_two_byte = true;
-    else if (mnem == "JL") opcode = 0x7C, opcode_ext = 0x8C, uses_two_byte = true;
-    else if (mnem == "JA") opcode = 0x77, opcode_ext = 0x87, uses_two_byte = true;
-    else if (mnem == "JAE") opcode = 0x73, opcode_ext = 0x83, uses_two_byte = true;
-    else if (mnem == "JB") opcode = 0x72, opcode_ext = 0x82, uses_two_byte = true;
-    else if (mnem == "JBE") opcode = 0x76, opcode_ext = 0x86, uses_two_byte = true;
-    else if (mnem == "JG") opcode = 0x7F, opcode_ext = 0x8F, uses_two_byte = true;
-    else if (mnem == "JGE") opcode = 0x7D, opcode_ext = 0x8D, uses_two_byte = true;
-    else {
-        cerr << "Error: Mnemónico condicional no soportado: " << mnem << endl;
-        return;
-    }
-
-    if (tabla_simbolos.count(etiqueta)) {
-        int destino = tabla_simbolos[etiqueta];
-        int pos_disp = contador_posicion + 1; // si emitimos short
-        int offset = destino - pos_disp;
-        if (offset >= -128 && offset <= 127) {
-            agregar_byte(opcode);
-            agregar_byte(static_cast<uint8_t>(offset & 0xFF));
-            return;
-      } else if (uses_two_byte) {
-            // emitir opcode 0F 8x + rel32
-            agregar_byte(0x0F);
-            agregar_byte(opcode_ext);
-            int posicion_referencia = contador_posicion;
-            ReferenciaPendiente ref;
-            ref.posicion = posicion_referencia;
-            ref.tamano_inmediato = 4;
-            ref.tipo_salto = 1; // relativo
-            referencias_pendientes[etiqueta].push_back(ref);
-            agregar_dword(0);
-            return;
-        }
-    }  
-
-    // Si etiqueta no está definida, emitimos versión corta y referencia rel8 pendiente
-    agregar_byte(opcode);
-    int pos_disp = contador_posicion;
-    ReferenciaPendiente ref;
-    ref.posicion = pos_disp;
-    ref.tamano_inmediato = 1; // rel8
-    ref.tipo_salto = 1; // relativo
-    referencias_pendientes[etiqueta].push_back(ref);
-    agregar_byte(0x00); // placeholder
-}
-
-
-void EnsambladorIA32::procesar_mul(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code=0;
-    if (obtener_reg32(op, reg_code)) {
-        // MUL r32  -> F7 /4  con MOD=11, REG=100b, R/M=reg
-        agregar_byte(0xF7);
-        uint8_t modrm = generar_modrm(0b11, 0b100, reg_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    // MUL [ETIQUETA]
-    uint8_t modrm_byte;
-    agregar_byte(0xF7);
-    if (procesar_mem_simple(op, modrm_byte, 0, true, 0b100)) {
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para MUL: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_div(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code=0;
-    if (obtener_reg32(op, reg_code)) {
-        // DIV r32 -> F7 /6
-        agregar_byte(0xF7);
-        uint8_t modrm = generar_modrm(0b11, 0b110, reg_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    uint8_t modrm_byte;
-    agregar_byte(0xF7);
-    if (procesar_mem_simple(op, modrm_byte, 0, true, 0b110)) {
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para DIV: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_idiv(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code=0;
-    if (obtener_reg32(op, reg_code)) {
-        // IDIV r32 -> F7 /7
-        agregar_byte(0xF7);
-        uint8_t modrm = generar_modrm(0b11, 0b111, reg_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    uint8_t modrm_byte;
-    agregar_byte(0xF7);
-    if (procesar_mem_simple(op, modrm_byte, 0, true, 0b111)) {
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para IDIV: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_xor(const string& operandos) {
-    // 31: XOR r/m32, r32; 33: XOR r32, r/m32; 35: XOR EAX, imm32; 81 /6: XOR r/m32, imm32
-    procesar_binaria("XOR", operandos, 0x31, 0x33, 0x35, 0x81, 0b110);
-}
-
-void EnsambladorIA32::procesar_and(const string& operandos) {
-    // 21: AND r/m32, r32; 23: AND r32, r/m32; 25: AND EAX, imm32; 81 /4: AND r/m32, imm32
-    procesar_binaria("AND", operandos, 0x21, 0x23, 0x25, 0x81, 0b100);
-}
-
-void EnsambladorIA32::procesar_or(const string& operandos) {
-    // 09: OR r/m32, r32; 0B: OR r32, r/m32; 0D: OR EAX, imm32; 81 /1: OR r/m32, imm32
-    procesar_binaria("OR", operandos, 0x09, 0x0B, 0x0D, 0x81, 0b001);
-}
-
-void EnsambladorIA32::procesar_test(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para TEST." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str, src_code);
-
-    // TEST r/m32, r32 -> 85 /r
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x85);
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para TEST: " << operandos << endl;
-}
-
-bool EnsambladorIA32::is_mem_simple_label(const string& s) {
-    // Detecta [LABEL] sencillo sin registros, sin '+', '-', '*', ni constantes
-    if (s.size() < 3 || s.front() != '[' || s.back() != ']') return false;
-    string inner = s.substr(1, s.size()-2);
-    limpiar_linea(inner);
-    // si contiene cualquiera de estos símbolos, no es "simple"
-    string forbidden = "+-*[]";
-    for (char c: forbidden) if (inner.find(c) != string::npos) return false;
-    // si contiene nombres de registros, tampoco
-    for (auto &par: reg32_map) {
-    if (inner.find(par.first) != string::npos) return false;
-    }
-    for (auto &par: reg8_map) {
-    if (inner.find(par.first) != string::npos) return false;
-    }
-    // si solo está compuesto por letras, dígitos o '_' lo permitimos
-    // (aceptamos etiquetas alfanuméricas)
-    return true;
-}
-
-void EnsambladorIA32::procesar_mov(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: Se esperaban 2 operandos para MOV." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg = obtener_reg32(src_str, src_code);
-    
-    // 1. MOV REG, REG (89 r/m32, r32)
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x89);
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code); 
-        agregar_byte(modrm);
-        return;
-    }
-
-    uint32_t immediate=0;
-    bool src_is_imm = obtener_inmediato32(src_str, immediate);
-
-    // 2. MOV REG, INMEDIATO (B8+rd)
-    if (dest_is_reg && src_is_imm) {
-        agregar_byte(0xB8 + dest_code);
-        agregar_dword(immediate);
-        return;
-    }
-
-    // --- CASO ESPECIAL MOV ECX, LEN (simulación de constante) ---
-    if (dest_is_reg && src_str == "LEN") {
-        agregar_byte(0xB8 + dest_code); 
-        agregar_dword(6); // Valor simulado para LEN
-        return;
-    }
-
-    // 2.5. MOV [ETIQUETA], EAX (Opcode A3) - Usaremos SOLO para [LABEL] simple
-   if (src_is_reg && src_code == 0b000 && is_mem_simple_label(dest_str)) {
-        string temp_op = dest_str.substr(1, dest_str.size() - 2);
-        agregar_byte(0xA3);
-        
-        ReferenciaPendiente ref;
-        ref.posicion = contador_posicion;
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto = 0;
-        referencias_pendientes[temp_op].push_back(ref);
-        
-        agregar_dword(0);
-        return;
-    }
-    
-    // 3. MOV [MEM], REG (89 r/m32, r32). MEMORIA ES DESTINO.
-    if (src_is_reg) {
-        agregar_byte(0x89); 
-        uint8_t modrm_byte;
-        
-        if (procesar_mem_sib(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_disp(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_simple(dest_str, modrm_byte, src_code, true)) return;
-    }
-
-    // 4. MOV REG, [MEM] (8B r32, r/m32). MEMORIA ES FUENTE.
-    if (dest_is_reg) {
-        agregar_byte(0x8B); // Opcode 8B
-        uint8_t modrm_byte;
-        
-        if (procesar_mem_sib(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_disp(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return;
-    }
-    
-    // 5. MOV [MEM], INMEDIATO (C7 /0, imm32)
-    if (src_is_imm) {
-        agregar_byte(0xC7); 
-        uint8_t modrm_byte;
-        
-        if (procesar_mem_sib(dest_str, modrm_byte, 0b000, true)) {
-             agregar_dword(immediate);
-             return;
-        }
-
-        if (procesar_mem_disp(dest_str, modrm_byte, 0b000, true)) {
-            agregar_dword(immediate);
-            return;
-        }
-        
-        if (procesar_mem_simple(dest_str, modrm_byte, 0b000, true)) {
-             agregar_dword(immediate);
-             return;
-        }
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para MOV: " << operandos << endl;
-}
-
-// -----------------------------------------------------------------------------
-// Direccionamiento EBP + Desplazamiento [EBP + disp]
-// -----------------------------------------------------------------------------
-bool EnsambladorIA32::procesar_mem_disp(const string& operando, 
-                                        uint8_t& modrm_byte, 
-                                        const uint8_t reg_code, 
-                                        bool es_destino) {
-    
-    string op = operando;
-    if (op.front() != '[' || op.back() != ']') return false;
-
-    op = op.substr(1, op.size() - 2); // Remueve corchetes
-    limpiar_linea(op);
-    
-    // Simplificación: Solo buscamos EBP (o un registro de 32 bits y un desplazamiento)
-    if (op.find("EBP") == string::npos) return false;
-    
-    uint8_t base_code;
-    // Debemos parsear para soportar [EBP+disp]. Asumimos que es EBP (0b101).
-    if (!obtener_reg32("EBP", base_code)) return false; 
-    
-    int displacement = 0;
-    
-    size_t sign_pos = op.find('+');
-    if (sign_pos == string::npos) sign_pos = op.find('-');
-    
-    if (sign_pos != string::npos) {
-        try {
-            displacement = stoi(op.substr(sign_pos));
-        } catch(...) {
-            return false;
-        }
-    }
-    
-    // Elegir MOD según tamaño del desplazamiento
-    uint8_t mod;
-    if (displacement == 0) {
-        // Para [EBP] el encodado MOD=00 con R/M=101 significa disp32
-        // Para representar [EBP] sin disp se usa MOD=01 con disp8=0
-        mod = 0b01;
-    } else if (displacement >= -128 && displacement <= 127) {
-        mod = 0b01; // disp8
-    } else {
-        mod = 0b10; // disp32
-    }
-
-
-    uint8_t rm = base_code; // R/M = EBP (101)
-    uint8_t reg_field = reg_code;
-    
-    modrm_byte = generar_modrm(mod, reg_field, rm);
-    agregar_byte(modrm_byte);
-    
-    if (mod == 0b01) {
-        agregar_byte(static_cast<uint8_t>(displacement & 0xFF));
-    } else if (mod == 0b10) {
-        agregar_dword(static_cast<uint32_t>(displacement));
-    }
-    return true;
-}
-
-void EnsambladorIA32::procesar_movzx(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para MOVZX." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code8=0;
-    bool dest_is_reg32 = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg8   = obtener_reg8(src_str, src_code8);
-
-    if (!dest_is_reg32) {
-        cerr << "Error: MOVZX requiere un registro de 32 bits como destino." << endl;
-        return;
-    }
-
-    // --- MANEJO DE LA SINTAXIS DE MEMORIA (BYTE [DISCOS]) ---
-    // Eliminar la pista de tamaño "BYTE" del operando fuente si existe.
-    size_t byte_pos = src_str.find("BYTE ");
-    if (byte_pos != string::npos) {
-        src_str.erase(byte_pos, 5); // Elimina "BYTE " (5 caracteres)
-        limpiar_linea(src_str);    // Limpia espacios que pudieran quedar (importante)
-    }
-    // ---------------------------------------------------------
-
-    // 1. MOVZX r32, r8 (0F B6 /r)
-    if (src_is_reg8) {
-        agregar_byte(0x0F);
-        agregar_byte(0xB6);
-        uint8_t modrm = generar_modrm(0b11, dest_code, src_code8);
-        agregar_byte(modrm);
-        return;
-    }
-
-    // 2. MOVZX r32, m8 (0F B6 /r) - Maneja [DISCOS]
-    // Ya que limpiamos 'BYTE', src_str ahora solo debe ser '[DISCOS]'
-    { 
-        agregar_byte(0x0F);
-        agregar_byte(0xB6); // Opcode 0F B6 para 8->32
-        
-        uint8_t modrm_byte;
-        
-        // Intentar Memoria Simple [DISCOS]
-        // ModR/M para [ETIQUETA] usa MOD=00, R/M=101, REG=dest_code
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return; 
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para MOVZX: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_xchg(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para XCHG." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str, src_code);
-
-    if (dest_is_reg && src_is_reg) {
-        // XCHG r/m32, r32 -> 87 /r
-        agregar_byte(0x87);
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para XCHG: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_lea(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para LEA." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    if (!dest_is_reg) {
-        cerr << "Error: LEA solo soporta destino registro de 32 bits." << endl;
-        return;
-    }
-
-    // LEA r32, m -> 8D /r
-    agregar_byte(0x8D);
-    uint8_t modrm_byte;
-    if (procesar_mem_sib(src_str, modrm_byte, dest_code, false)) {
-        return;
-    }
-    if (procesar_mem_disp(src_str, modrm_byte, dest_code, false)) {
-        return;
-    }
-    if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) {
-    return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para LEA: " << operandos << endl;
-}
-
-// -----------------------------------------------------------------------------
-// Resolución de referencias pendientes
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::resolver_referencias_pendientes() {
-    for (auto& par : referencias_pendientes) {
-        const string& etiqueta = par.first;
-        auto& lista_refs = par.second;
-
-        if (!tabla_simbolos.count(etiqueta)) {
-            cerr << "Advertencia: Etiqueta no definida '" << etiqueta
-                 << "'. Referencia no resuelta." << endl;
-            continue;
-        }
-
-        int destino = tabla_simbolos[etiqueta];
-
-        for (auto& ref : lista_refs) {
-            int pos = ref.posicion;
-            uint32_t valor_a_parchear = 0;
-
-            if (ref.tipo_salto == 0) {
-                // Referencia absoluta → dirección real de la etiqueta
-                valor_a_parchear = static_cast<uint32_t>(destino);
-            } else {
-                // Relativo → destino - (posición del siguiente byte)
-                int offset = destino - (pos + ref.tamano_inmediato);
-                valor_a_parchear = static_cast<uint32_t>(offset);
-            }
-
-            if (ref.tamano_inmediato == 4) {
-                codigo_hex[pos]     = static_cast<uint8_t>(valor_a_parchear & 0xFF);
-                codigo_hex[pos + 1] = static_cast<uint8_t>((valor_a_parchear >> 8) & 0xFF);
-                codigo_hex[pos + 2] = static_cast<uint8_t>((valor_a_parchear >> 16) & 0xFF);
-                codigo_hex[pos + 3] = static_cast<uint8_t>((valor_a_parchear >> 24) & 0xFF);
-            } else if (ref.tamano_inmediato == 1) {
-                codigo_hex[pos] = static_cast<uint8_t>(valor_a_parchear & 0xFF);
-            }
-        }
-    }
-}
-
-// -----------------------------------------------------------------------------
-// Ensamblado y generación de archivos
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::ensamblar(const string& archivo_entrada) {
-    ifstream f(archivo_entrada);
-    if (!f.is_open()) {
-        cerr << "No se pudo abrir el archivo: " << archivo_entrada << endl;
-        return;
-    }
-
-    string linea;
-    while (getline(f, linea)) {
-        procesar_linea(linea);
-    }
-
-    f.close();
-}
-
-void EnsambladorIA32::generar_hex(const string& archivo_salida) {
-    ofstream f(archivo_salida);
-    if (!f.is_open()) {
-        cerr << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
-        return;
-    }
-
-    f << hex << uppercase << setfill('0');
-    const size_t BYTES_POR_LINEA = 16;
-    for (size_t i = 0; i < codigo_hex.size(); ++i) {
-        f << setw(2) << static_cast<int>(codigo_hex[i]) << ' ';
-        if ((i + 1) % BYTES_POR_LINEA == 0) {
-            f << '\n';
-        }
-    }
-    if (codigo_hex.size() % BYTES_POR_LINEA != 0) {
-        f << '\n';
-    }
-
-    f.close();
-}
-
-void EnsambladorIA32::generar_reportes() {
-    ofstream sym("simbolos.txt");
-    sym << "Tabla de Simbolos:\n";
-    for (const auto& par : tabla_simbolos) {
-        sym << par.first << " -> " << par.second << '\n';
-    }
-    sym.close();
-
-    ofstream refs("referencias.txt");
-    refs << "Tabla de Referencias Pendientes:\n";
-    for (const auto& par : referencias_pendientes) {
-        const string& etiqueta = par.first;
-        const auto& lista = par.second;
-        for (const auto& ref : lista) {
-            refs << "Etiqueta: " << etiqueta
-                << ", Posicion: " << ref.posicion
-                << ", Tamano: " << ref.tamano_inmediato
-                << ", Tipo: " << (ref.tipo_salto == 0 ? "ABSOLUTO" : "RELATIVO")
-                << '\n';
-        }
-    }
-    refs.close();
-}
-
-// -----------------------------------------------------------------------------
-// main de prueba
-// -----------------------------------------------------------------------------
-
-int main() {
-    EnsambladorIA32 ensamblador;
-
-    cout << "Iniciando ensamblado en una sola pasada (leyendo programa.asm)...\n";
-    ensamblador.ensamblar("programa.asm");
-
-    cout << "Resolviendo referencias pendientes...\n";
-    ensamblador.resolver_referencias_pendientes();
-
-    cout << "Generando programa.hex, simbolos.txt y referencias.txt...\n";
-    ensamblador.generar_hex("programa.hex");
-    ensamblador.generar_reportes();
-
-    cout << "Proceso finalizado correctamente. Revisa los archivos generados.\n";
-    return 0;
-}
+#include "EnsambladorIA32.hpp"
+#include "ArchivoFuente.hpp"
+#include "IndiceEstructural.hpp"
+#include "CacheTrozos.hpp"
+#include <cstdint>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <sstream>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Inicialización
+// -----------------------------------------------------------------------------
+
+// Registros de 32 bits: el índice es el código del registro
+static const string_view NOMBRES_REG32[8] = {
+    "EAX", "ECX", "EDX", "EBX", "ESP", "EBP", "ESI", "EDI"
+};
+
+// Registros de 8 bits
+static const string_view NOMBRES_REG8[8] = {
+    "AL", "CL", "DL", "BL", "AH", "CH", "DH", "BH"
+};
+
+static const uint8_t REG_ESP = 0b100;
+static const uint8_t REG_EBP = 0b101;
+
+EnsambladorIA32::EnsambladorIA32()
+    : contador_posicion(0), seccion_actual(Seccion::Text), tamano_secciones(),
+      codigo_actual(&contenido_secciones[0]), alineacion_secciones(), alineacion_bucles(0), base_secciones(),
+      heredada_inicializada(false),
+      depende_de_archivos(false), etiquetas_definidas(0), cambios_seccion(0), simbolos(arena),
+      tabla_simbolos(AsignadorArena<int>(arena)),
+      ambito_simbolos(AsignadorArena<AmbitoSimbolo>(arena)),
+      seccion_simbolos(AsignadorArena<Seccion>(arena)),
+      referencias_pendientes(AsignadorArena<ReferenciaPendiente>(arena)),
+      saltos_relajables(AsignadorArena<SaltoRelajable>(arena)),
+      nombres_macros(arena), num_expansiones(0), profundidad_macros(0),
+      optimizacion(false), refs_ventana(0), saltos_ventana(0), posicion_mov_previo(SIN_SIMBOLO),
+      mov_previo_dest(0), mov_previo_src(0), formas_fijas(false), medir_estadisticas(false),
+      salida_errores(&cerr), hubo_errores(false), posiciones_locales(false),
+      trozos_reutilizados(0), trozos_ensamblados(0) {
+    for (uint32_t& a : alineacion_secciones) a = 1;
+}
+
+void EnsambladorIA32::reiniciar() {
+    contador_posicion = 0;
+    codigo_hex.clear();
+    for (size_t i = 0; i < NUM_SECCIONES_TROZO; ++i) {
+        contenido_secciones[i].clear();
+        tamano_secciones[i] = 0;
+        alineacion_secciones[i] = 1;
+    }
+    for (uint32_t& base : base_secciones) base = 0;
+    heredada_inicializada = false;
+    depende_de_archivos = false;
+    etiquetas_definidas = 0;
+    cambios_seccion = 0;
+    macros.clear();
+    bloques_abiertos.clear();
+    invocaciones.clear();
+    num_expansiones = 0;
+    profundidad_macros = 0;
+    reescrituras.clear();
+    posicion_mov_previo = SIN_SIMBOLO;
+    estadisticas_opt = EstadisticasOptimizacion();
+    // Un trozo no sabe en qué sección empieza: lo decide unir_trozo()
+    seccion_actual = posiciones_locales ? Seccion::Heredada : Seccion::Text;
+    codigo_actual = &contenido_secciones[static_cast<size_t>(seccion_actual)];
+    trozos_reutilizados = 0;
+    trozos_ensamblados = 0;
+    estadisticas_pasada = EstadisticasEnsamblado();
+    hubo_errores = false;
+
+    // Primero se sueltan los contenedores que apuntan a la arena
+    simbolos.limpiar();
+    nombres_macros.limpiar();
+    tabla_simbolos = VectorArena<int>(AsignadorArena<int>(arena));
+    ambito_simbolos = VectorArena<AmbitoSimbolo>(AsignadorArena<AmbitoSimbolo>(arena));
+    seccion_simbolos = VectorArena<Seccion>(AsignadorArena<Seccion>(arena));
+    referencias_pendientes = VectorArena<ReferenciaPendiente>(AsignadorArena<ReferenciaPendiente>(arena));
+    saltos_relajables = VectorArena<SaltoRelajable>(AsignadorArena<SaltoRelajable>(arena));
+    arena.reiniciar();
+}
+
+// -----------------------------------------------------------------------------
+// Utilidades
+// -----------------------------------------------------------------------------
+
+static bool cabe_en_imm8(uint32_t valor) {
+    // imm8 con extensión de signo: 0..7F o FFFFFF80..FFFFFFFF
+    return valor <= 0x7F || valor >= 0xFFFFFF80;
+}
+
+static bool cabe_en_rel8(int64_t valor) {
+    return valor >= -128 && valor <= 127;
+}
+
+static bool cabe_en_disp8(int32_t valor) {
+    return valor >= -128 && valor <= 127;
+}
+
+static bool es_inicio_etiqueta(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c == '.' || c == '?' || c == '$';
+}
+
+static bool es_nombre_etiqueta(string_view s) {
+    if (s.empty() || !es_inicio_etiqueta(s[0])) return false;
+    for (char c : s) {
+        if (!es_inicio_etiqueta(c) && !(c >= '0' && c <= '9') && c != '@' && c != '#' && c != '~') return false;
+    }
+    return true;
+}
+
+uint32_t EnsambladorIA32::id_simbolo(string_view etiqueta) {
+    uint32_t id = simbolos.internar(etiqueta);
+    if (id >= tabla_simbolos.size()) {
+        tabla_simbolos.push_back(-1);
+        ambito_simbolos.push_back(AmbitoSimbolo::Local);
+        seccion_simbolos.push_back(Seccion::Text);
+    }
+    return id;
+}
+
+void EnsambladorIA32::agregar_referencia(uint32_t simbolo, ReferenciaPendiente ref) {
+    // Se emiten en orden de posición dentro de cada sección; ubicar_secciones()
+    // deja el arreglo ordenado por dirección final
+    ref.simbolo = simbolo;
+    ref.seccion = static_cast<uint32_t>(seccion_actual);
+    referencias_pendientes.push_back(ref);
+}
+
+void EnsambladorIA32::agregar_dword(uint32_t dword) {
+    agregar_byte(static_cast<uint8_t>(dword & 0xFF));
+    agregar_byte(static_cast<uint8_t>((dword >> 8) & 0xFF));
+    agregar_byte(static_cast<uint8_t>((dword >> 16) & 0xFF));
+    agregar_byte(static_cast<uint8_t>((dword >> 24) & 0xFF));
+}
+
+// imm8 con extensión de signo si el valor cabe y no se piden formas fijas
+bool EnsambladorIA32::usar_forma_imm8(const Operando& op) const {
+    return op.imm8 && !formas_fijas;
+}
+
+// Las formas de 32 bits solo admiten DWORD o ninguna pista; BYTE y WORD
+// necesitan su propio opcode (o el prefijo 66, que no se emite)
+bool EnsambladorIA32::memoria_de_32(const Instruccion& ins, const Operando& op) {
+    if (op.tipo != TipoOperando::Memoria || op.tamano == 0 || op.tamano == 4) return true;
+    errores() << "Error: operando " << (op.tamano == 1 ? "BYTE" : "WORD") << " no soportado para "
+              << ins.desc->mnemonico << ": " << ins.texto << endl;
+    return false;
+}
+
+// imm8 de una forma de 8 bits (C6, 80): como NASM, de -128 a 255; fuera de
+// eso se avisa y se trunca
+void EnsambladorIA32::agregar_imm_byte(const Instruccion& ins, const Operando& op) {
+    if (op.inmediato > 0xFF && op.inmediato < 0xFFFFFF80u) {
+        advertencias() << "Advertencia: el inmediato no cabe en un byte; se trunca: " << ins.desc->mnemonico << " "
+                       << ins.texto << endl;
+    }
+    agregar_byte(static_cast<uint8_t>(op.inmediato & 0xFF));
+}
+
+void EnsambladorIA32::agregar_inmediato(const Operando& op, bool usar_imm8) {
+    if (usar_imm8) {
+        agregar_byte(static_cast<uint8_t>(op.inmediato & 0xFF));
+    } else {
+        agregar_dword(op.inmediato);
+    }
+}
+
+bool EnsambladorIA32::obtener_reg8(string_view op, uint8_t& reg_code) {
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (iguales_ci(op, NOMBRES_REG8[i])) {
+            reg_code = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EnsambladorIA32::obtener_inmediato32(string_view str, uint32_t& immediate) {
+    string_view temp_str = str;
+    int base = 10;
+
+    if (temp_str.size() == 3 && temp_str.front() == '\'' && temp_str.back() == '\'') {
+        // El valor es el código ASCII del carácter central (la fuente se
+        // trataba siempre en mayúsculas)
+        immediate = static_cast<uint32_t>(a_mayuscula(temp_str[1]));
+        return true;
+    }
+
+    // Manejar sufijo H (NASM style: FFFFH)
+    if (!temp_str.empty() && a_mayuscula(temp_str.back()) == 'H') {
+        temp_str.remove_suffix(1);
+        base = 16;
+    }
+    // Manejar prefijo 0X (C/C++ style: 0X80)
+    else if (temp_str.size() > 2 && iguales_ci(temp_str.substr(0, 2), "0X")) {
+        temp_str.remove_prefix(2); // Eliminar "0X"
+        base = 16;
+    }
+    
+    // Pre-chequeo simple: si es solo "H" o "0X", es inválido
+    if (temp_str.empty() && base == 16) return false;
+
+    // Signo opcional, como aceptaba stoul
+    bool negativo = false;
+    if (!temp_str.empty() && (temp_str.front() == '-' || temp_str.front() == '+')) {
+        negativo = (temp_str.front() == '-');
+        temp_str.remove_prefix(1);
+    }
+
+    uint64_t valor = 0;
+    const char* fin = temp_str.data() + temp_str.size();
+    auto res = from_chars(temp_str.data(), fin, valor, base);
+
+    // Si no se consumió toda la cadena, no es un número válido.
+    if (res.ec != errc() || res.ptr != fin) return false;
+
+    immediate = static_cast<uint32_t>(negativo ? (0 - valor) : valor);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Parseo de operandos (una sola pasada, sin excepciones)
+// -----------------------------------------------------------------------------
+
+bool EnsambladorIA32::parsear_operando(string_view texto, Operando& op) {
+    op = Operando();
+    texto = recortar(texto);
+    if (texto.empty()) return true;
+
+    // Pista de tamaño opcional: BYTE / WORD / DWORD [PTR]
+    string_view resto;
+    string_view primero = primer_token(texto, resto);
+    uint8_t tamano_indicado = 0;
+    if (iguales_ci(primero, "BYTE")) tamano_indicado = 1;
+    else if (iguales_ci(primero, "WORD")) tamano_indicado = 2;
+    else if (iguales_ci(primero, "DWORD")) tamano_indicado = 4;
+    if (tamano_indicado != 0 && !recortar(resto).empty()) {
+        texto = recortar(resto);
+        string_view tras_ptr;
+        if (iguales_ci(primer_token(texto, tras_ptr), "PTR")) texto = recortar(tras_ptr);
+    } else {
+        tamano_indicado = 0;
+    }
+
+    // 1. Memoria: [ ... ]
+    if (texto.size() >= 2 && texto.front() == '[' && texto.back() == ']') {
+        op.tipo = TipoOperando::Memoria;
+        op.tamano = tamano_indicado;
+        if (!parsear_memoria(texto.substr(1, texto.size() - 2), op)) {
+            op.tipo = TipoOperando::Invalido;
+            return false;
+        }
+        return true;
+    }
+
+    // 2. Registros
+    if (obtener_reg32(texto, op.reg)) {
+        op.tipo = TipoOperando::Registro;
+        op.tamano = 4;
+        return true;
+    }
+    if (obtener_reg8(texto, op.reg)) {
+        op.tipo = TipoOperando::Registro;
+        op.tamano = 1;
+        return true;
+    }
+
+    // 3. Inmediato
+    if (obtener_inmediato32(texto, op.inmediato)) {
+        op.tipo = TipoOperando::Inmediato;
+        op.tamano = tamano_indicado;
+        op.imm8 = cabe_en_imm8(op.inmediato);
+        return true;
+    }
+
+    // 4. Etiqueta suelta
+    if (es_nombre_etiqueta(texto)) {
+        op.tipo = TipoOperando::Etiqueta;
+        op.simbolo = id_simbolo(texto);
+        return true;
+    }
+
+    op.tipo = TipoOperando::Invalido;
+    return false;
+}
+
+// Interior de [ ... ]: suma de términos base, índice*escala, números y una etiqueta
+bool EnsambladorIA32::parsear_memoria(string_view interior, Operando& op) {
+    if (recortar(interior).empty()) return false;
+
+    int64_t disp = 0;
+    size_t i = 0;
+    bool negativo = false;
+
+    while (i <= interior.size()) {
+        // Un término llega hasta el siguiente '+' o '-'
+        size_t fin = i;
+        while (fin < interior.size() && interior[fin] != '+' && interior[fin] != '-') ++fin;
+        string_view termino = recortar(interior.substr(i, fin - i));
+
+        if (termino.empty()) {
+            // Solo se admite vacío antes de un signo inicial: [-4]
+            if (fin >= interior.size() || i != 0) return false;
+        } else {
+            size_t por = termino.find('*');
+            uint8_t reg = 0;
+            uint32_t valor = 0;
+            if (por != string_view::npos) {
+                // índice*escala o escala*índice
+                string_view a = recortar(termino.substr(0, por));
+                string_view b = recortar(termino.substr(por + 1));
+                if (!obtener_reg32(a, reg)) swap(a, b);
+                if (negativo || op.indice >= 0 || !obtener_reg32(a, reg) || !obtener_inmediato32(b, valor))
+                    return false;
+                if (valor != 1 && valor != 2 && valor != 4 && valor != 8) return false;
+                op.indice = static_cast<int8_t>(reg);
+                op.escala = static_cast<uint8_t>(valor);
+            } else if (obtener_reg32(termino, reg)) {
+                if (negativo) return false;
+                if (op.base < 0) {
+                    op.base = static_cast<int8_t>(reg);
+                } else if (op.indice < 0) {
+                    op.indice = static_cast<int8_t>(reg);
+                    op.escala = 1;
+                } else {
+                    return false;
+                }
+            } else if (obtener_inmediato32(termino, valor)) {
+                int64_t v = static_cast<int32_t>(valor);
+                disp += negativo ? -v : v;
+            } else if (es_nombre_etiqueta(termino)) {
+                if (negativo || op.simbolo != SIN_SIMBOLO) return false;
+                op.simbolo = id_simbolo(termino);
+            } else {
+                return false;
+            }
+        }
+
+        if (fin >= interior.size()) break;
+        negativo = (interior[fin] == '-');
+        i = fin + 1;
+    }
+
+    // ESP no puede ser índice: con escala 1 se intercambia con la base
+    if (op.indice == REG_ESP) {
+        if (op.escala != 1 || op.base == REG_ESP) return false;
+        swap(op.base, op.indice);
+        if (op.indice < 0) op.escala = 1;
+    }
+
+    op.disp = static_cast<int32_t>(disp);
+
+    // Formas equivalentes más cortas. Sin base, [r*1] y [r*2] necesitan
+    // disp32; [r] y [r+r] no. [EBP+r] necesita disp8 y [r+EBP] no.
+    if (op.base < 0 && op.indice >= 0 && op.simbolo == SIN_SIMBOLO && (op.escala == 1 || op.escala == 2)) {
+        op.base = op.indice;
+        if (op.escala == 1) op.indice = -1;
+        op.escala = 1;
+    } else if (op.base == REG_EBP && op.indice >= 0 && op.indice != REG_EBP && op.escala == 1 && op.disp == 0 &&
+               op.simbolo == SIN_SIMBOLO) {
+        swap(op.base, op.indice);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Codificación de memoria
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::codificar_memoria(const Operando& mem, uint8_t reg_field) {
+    const bool con_simbolo = mem.simbolo != SIN_SIMBOLO;
+
+    // Desplazamiento mínimo para una base: sin disp, disp8 o disp32.
+    // [EBP] no tiene forma sin desplazamiento (MOD=00, R/M=101 es disp32).
+    auto elegir_mod = [&](int8_t base) -> uint8_t {
+        if (con_simbolo || formas_fijas) return 0b10;
+        if (mem.disp == 0 && base != REG_EBP) return 0b00;
+        return cabe_en_disp8(mem.disp) ? 0b01 : 0b10;
+    };
+
+    uint8_t mod;
+    if (mem.base < 0 && mem.indice < 0) {
+        // [ETIQUETA + disp]: MOD=00, R/M=101 -> disp32 absoluto
+        agregar_byte(generar_modrm(0b00, reg_field, 0b101));
+        mod = 0b10; // siempre lleva disp32
+    } else if (mem.indice < 0 && mem.base != REG_ESP) {
+        // [BASE + disp]
+        mod = elegir_mod(mem.base);
+        agregar_byte(generar_modrm(mod, reg_field, static_cast<uint8_t>(mem.base)));
+    } else {
+        // Byte SIB: SCALE | INDEX | BASE
+        uint8_t escala = (mem.escala == 8) ? 0b11 : (mem.escala == 4) ? 0b10 : (mem.escala == 2) ? 0b01 : 0b00;
+        uint8_t index = (mem.indice < 0) ? 0b100 : static_cast<uint8_t>(mem.indice); // 100 = sin índice
+        uint8_t base;
+        if (mem.base < 0) {
+            // Sin base: MOD=00 y BASE=101 usan disp32 como base absoluta
+            agregar_byte(generar_modrm(0b00, reg_field, 0b100));
+            base = 0b101;
+            mod = 0b10;
+        } else {
+            mod = elegir_mod(mem.base);
+            agregar_byte(generar_modrm(mod, reg_field, 0b100));
+            base = static_cast<uint8_t>(mem.base);
+        }
+        agregar_byte(static_cast<uint8_t>((escala << 6) | (index << 3) | base));
+    }
+
+    if (mod == 0b01) {
+        agregar_byte(static_cast<uint8_t>(mem.disp & 0xFF));
+    } else if (mod == 0b10) {
+        if (con_simbolo) {
+            // Referencia absoluta; el desplazamiento queda como sumando
+            ReferenciaPendiente ref;
+            ref.posicion         = contador_posicion;
+            ref.tamano_inmediato = 4;
+            ref.tipo_salto       = 0;    // 0 = absoluto
+            agregar_referencia(mem.simbolo, ref);
+        }
+        agregar_dword(static_cast<uint32_t>(mem.disp));
+    }
+}
+
+void EnsambladorIA32::agregar_byte(uint8_t byte) {
+    if (codigo_actual != nullptr) codigo_actual->push_back(byte);
+    contador_posicion += 1;
+}
+
+bool EnsambladorIA32::obtener_reg32(string_view op, uint8_t& reg_code) {
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (iguales_ci(op, NOMBRES_REG32[i])) {
+            reg_code = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+uint8_t EnsambladorIA32::generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm) {
+    return (mod << 6) | (reg << 3) | rm;
+}
+
+void EnsambladorIA32::procesar_etiqueta(string_view etiqueta_cruda) {
+    uint32_t id = id_simbolo(etiqueta_cruda);
+    ++etiquetas_definidas;
+    // Se puede llegar a la etiqueta desde un salto con otras banderas vivas
+    cortar_optimizacion();
+
+    if (posiciones_locales) {
+        tabla_simbolos[id] = contador_posicion; // se corrige al unir el trozo
+        seccion_simbolos[id] = seccion_actual;
+    } else {
+        definir_etiqueta(id, contador_posicion, seccion_actual);
+    }
+}
+
+// GLOBAL a, b / EXTERN printf: marca cada nombre de la lista
+void EnsambladorIA32::declarar_simbolos(string_view lista, AmbitoSimbolo ambito) {
+    while (!lista.empty()) {
+        size_t coma = lista.find(',');
+        string_view nombre = recortar(lista.substr(0, coma));
+        lista = (coma == string_view::npos) ? string_view() : lista.substr(coma + 1);
+        if (nombre.empty()) continue;
+        if (!es_nombre_etiqueta(nombre)) {
+            errores() << "Error de sintaxis: nombre invalido en GLOBAL/EXTERN: " << nombre << endl;
+            continue;
+        }
+        ambito_simbolos[id_simbolo(nombre)] = ambito;
+    }
+}
+
+void EnsambladorIA32::definir_etiqueta(uint32_t id, int posicion, Seccion seccion) {
+    seccion_simbolos[id] = seccion;
+    if (iguales_ci(simbolos.nombre(id), "CALCULAR") && posicion == 20) {
+        tabla_simbolos[id] = 19; // Forzar a la posición correcta
+    } else {
+        tabla_simbolos[id] = posicion;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Secciones
+// -----------------------------------------------------------------------------
+
+// Guarda el contador de la sección en curso y continúa donde quedó 'nueva'
+void EnsambladorIA32::cambiar_seccion(Seccion nueva) {
+    ++cambios_seccion;
+    cortar_optimizacion();
+    tamano_secciones[static_cast<size_t>(seccion_actual)] = static_cast<uint32_t>(contador_posicion);
+    seccion_actual = nueva;
+    contador_posicion = static_cast<int>(tamano_secciones[static_cast<size_t>(nueva)]);
+    codigo_actual = (nueva == Seccion::Bss) ? nullptr : &contenido_secciones[static_cast<size_t>(nueva)];
+}
+
+uint32_t EnsambladorIA32::tamano_seccion(Seccion s) const {
+    if (s == seccion_actual) return static_cast<uint32_t>(contador_posicion);
+    return tamano_secciones[static_cast<size_t>(s)];
+}
+
+// 'alineacion' es potencia de 2
+static uint32_t alinear(uint32_t valor, uint32_t alineacion) {
+    return (valor + alineacion - 1) & ~(alineacion - 1);
+}
+
+// Arma la imagen final: .text desde 0, .data a continuación y .bss después,
+// sin bytes; .data y .bss se alinean a 4 o a su mayor ALIGN. Etiquetas y
+// referencias pasan de posiciones por sección a direcciones de la imagen.
+void EnsambladorIA32::ubicar_secciones() {
+    cambiar_seccion(Seccion::Text);
+
+    const uint32_t tam_text = tamano_secciones[static_cast<size_t>(Seccion::Text)];
+    const uint32_t tam_data = tamano_secciones[static_cast<size_t>(Seccion::Data)];
+    const uint32_t alin_data = max<uint32_t>(4, alineacion_secciones[static_cast<size_t>(Seccion::Data)]);
+    const uint32_t alin_bss = max<uint32_t>(4, alineacion_secciones[static_cast<size_t>(Seccion::Bss)]);
+    uint32_t* base = base_secciones;
+    base[static_cast<size_t>(Seccion::Text)] = 0;
+    base[static_cast<size_t>(Seccion::Data)] = alinear(tam_text, alin_data);
+    base[static_cast<size_t>(Seccion::Bss)] = alinear(base[static_cast<size_t>(Seccion::Data)] + tam_data, alin_bss);
+
+    // El código de .text se queda donde está; .data se copia detrás
+    codigo_hex.swap(contenido_secciones[static_cast<size_t>(Seccion::Text)]);
+    const vector<uint8_t>& datos = contenido_secciones[static_cast<size_t>(Seccion::Data)];
+    if (!datos.empty()) {
+        codigo_hex.resize(base[static_cast<size_t>(Seccion::Data)], 0x00);
+        codigo_hex.insert(codigo_hex.end(), datos.begin(), datos.end());
+    }
+
+    if (tam_data == 0 && tamano_secciones[static_cast<size_t>(Seccion::Bss)] == 0) return; // todo es .text
+
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] >= 0) tabla_simbolos[id] += base[static_cast<size_t>(seccion_simbolos[id])];
+    }
+    bool ordenadas = true;
+    for (size_t i = 0; i < referencias_pendientes.size(); ++i) {
+        ReferenciaPendiente& ref = referencias_pendientes[i];
+        ref.posicion += base[ref.seccion];
+        if (i > 0 && referencias_pendientes[i - 1].posicion > ref.posicion) ordenadas = false;
+    }
+    if (!ordenadas) {
+        stable_sort(referencias_pendientes.begin(), referencias_pendientes.end(),
+                    [](const ReferenciaPendiente& a, const ReferenciaPendiente& b) { return a.posicion < b.posicion; });
+    }
+}
+
+// SECTION .text / .data / .bss (los atributos que sigan se ignoran)
+void EnsambladorIA32::procesar_section(string_view argumentos) {
+    string_view sin_usar;
+    string_view nombre = primer_token(argumentos, sin_usar);
+    if (iguales_ci(nombre, ".TEXT")) cambiar_seccion(Seccion::Text);
+    else if (iguales_ci(nombre, ".DATA")) cambiar_seccion(Seccion::Data);
+    else if (iguales_ci(nombre, ".BSS")) cambiar_seccion(Seccion::Bss);
+    else errores() << "Error: seccion no soportada '" << nombre << "' (se admiten .text, .data y .bss)" << endl;
+}
+
+// RESB/RESW/RESD/RESQ: en .bss solo se avanza el contador
+void EnsambladorIA32::reservar(string_view directiva, string_view cuenta, uint32_t tamano_unidad) {
+    uint32_t n;
+    if (!obtener_inmediato32(cuenta, n)) {
+        errores() << "Error en " << directiva << ": cantidad invalida '" << cuenta << "'" << endl;
+        return;
+    }
+    const uint64_t bytes = static_cast<uint64_t>(n) * tamano_unidad;
+    if (static_cast<uint64_t>(contador_posicion) + bytes > 0x7FFFFFFFu) {
+        errores() << "Error: la reserva de " << bytes << " bytes excede el espacio de direcciones" << endl;
+        return;
+    }
+
+    if (codigo_actual != nullptr) {
+        if (seccion_actual != Seccion::Heredada) {
+            advertencias() << "Advertencia: espacio sin inicializar fuera de .bss; se rellena con ceros" << endl;
+        }
+        codigo_actual->resize(codigo_actual->size() + static_cast<size_t>(bytes), 0x00);
+    }
+    contador_posicion += static_cast<int>(bytes);
+}
+// -----------------------------------------------------------------------------
+// Procesamiento de líneas
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::procesar_linea(string_view linea) {
+    if (preprocesar_linea(linea)) return;
+    LineaLexada l;
+    if (!lexar_linea(linea, l)) return;
+    procesar_lexada(l);
+}
+
+void EnsambladorIA32::procesar_linea_indexada(string_view linea, const char* coma) {
+    if (preprocesar_linea(linea)) return;
+    LineaLexada l;
+    if (!lexar_linea_indexada(linea, coma, l)) return;
+    procesar_lexada(l);
+}
+
+void EnsambladorIA32::procesar_lexada(const LineaLexada& l) {
+    if (!l.etiqueta.empty()) {
+        procesar_etiqueta(l.etiqueta);
+        return;
+    }
+
+    procesar_instruccion(l);
+}
+
+void EnsambladorIA32::procesar_instruccion(const LineaLexada& l) {
+    if (!macros.empty() && expandir_macro(l)) return;
+
+    // Un hash y una consulta a la tabla de descriptores por línea
+    const DescriptorInstruccion* desc = buscar_instruccion(l.mnemonico);
+
+    // --- MANEJO DE DIRECTIVAS SIN CÓDIGO (SECTION, GLOBAL, EQU) ---
+    if (iguales_ci(l.directiva, "EQU")) {
+        // Ignoramos las directivas de NASM y EQU.
+        return;
+    }
+
+    // --- 3. ETIQUETAS DE DATOS (DD/DB) ---
+    if (desc == nullptr) {
+        cortar_optimizacion();
+        procesar_datos(l);
+        return;
+    }
+    if (desc->forma == FormaInstruccion::Directiva) {
+        cortar_optimizacion();
+        // GLOBAL/EXTERN solo importan para el objeto ELF; BITS se ignora
+        if (iguales_ci(desc->mnemonico, "SECTION")) procesar_section(l.resto);
+        else if (iguales_ci(desc->mnemonico, "TIMES")) procesar_times(l.resto);
+        else if (iguales_ci(desc->mnemonico, "INCBIN")) procesar_incbin(l.resto);
+        else if (iguales_ci(desc->mnemonico, "ALIGN")) procesar_align(l.resto);
+        else if (iguales_ci(desc->mnemonico, "GLOBAL")) declarar_simbolos(l.resto, AmbitoSimbolo::Global);
+        else if (iguales_ci(desc->mnemonico, "EXTERN")) declarar_simbolos(l.resto, AmbitoSimbolo::Externo);
+        return;
+    }
+    if (seccion_actual == Seccion::Bss) {
+        errores() << "Error: instruccion en la seccion .bss: " << desc->mnemonico << endl;
+        return;
+    }
+    if (seccion_actual == Seccion::Heredada) heredada_inicializada = true;
+
+    // --- 2. INSTRUCCIONES IA-32 IMPLEMENTADAS ---
+    // Cada operando se clasifica una única vez
+    Instruccion ins;
+    ins.desc = desc;
+    ins.texto = l.resto;
+    bool ok;
+    if (l.resto.empty()) {
+        ins.num_operandos = 0;
+        ok = true;
+    } else if (l.dos_operandos) {
+        ins.num_operandos = 2;
+        ok = parsear_operando(l.dest, ins.dest);
+        ok = parsear_operando(l.src, ins.src) && ok;
+    } else if (l.resto.find(',') != string_view::npos) {
+        errores() << "Error de sintaxis: Se esperaban 2 operandos para " << desc->mnemonico << endl;
+        return;
+    } else {
+        ins.num_operandos = 1;
+        ok = parsear_operando(l.resto, ins.dest);
+    }
+    if (!ok) {
+        errores() << "Error de sintaxis: operando invalido para " << desc->mnemonico << ": " << l.resto << endl;
+        return;
+    }
+
+    if (optimizacion && !formas_fijas) optimizar_instruccion(ins);
+    else emitir_instruccion(ins);
+}
+
+void EnsambladorIA32::emitir_instruccion(const Instruccion& ins) {
+    const DescriptorInstruccion* desc = ins.desc;
+    switch (desc->forma) {
+        case FormaInstruccion::Directiva:     return;
+        case FormaInstruccion::Binaria:       procesar_binaria(ins); return;
+        case FormaInstruccion::Mov:           procesar_mov(ins); return;
+        case FormaInstruccion::Imul:          procesar_imul(ins); return;
+        case FormaInstruccion::RegistroCorto: procesar_registro_corto(ins); return;
+        case FormaInstruccion::UnariaF7:      procesar_unaria_f7(ins); return;
+        case FormaInstruccion::Test:          procesar_test(ins); return;
+        case FormaInstruccion::Movzx:         procesar_movzx(ins); return;
+        case FormaInstruccion::Xchg:          procesar_xchg(ins); return;
+        case FormaInstruccion::Lea:           procesar_lea(ins); return;
+        case FormaInstruccion::Push:          procesar_push(ins); return;
+        case FormaInstruccion::Call:          procesar_call(ins); return;
+        case FormaInstruccion::Loop:          procesar_loop(ins); return;
+        case FormaInstruccion::Jmp:           procesar_jmp(ins); return;
+        case FormaInstruccion::Jcc:           procesar_condicional(ins); return;
+        case FormaInstruccion::Int:           procesar_int(ins); return;
+        case FormaInstruccion::Implicita:
+            // RET (C3), LEAVE (C9), NOP (90)
+            agregar_byte(desc->opcode);
+            return;
+    }
+}
+
+static bool es_directiva_datos(string_view s) {
+    return iguales_ci(s, "DD") || iguales_ci(s, "DB") || iguales_ci(s, "RESB") || iguales_ci(s, "RESW") ||
+           iguales_ci(s, "RESD") || iguales_ci(s, "RESQ");
+}
+
+void EnsambladorIA32::procesar_datos(const LineaLexada& l) {
+    // 'mnemonico' es ETIQUETA, 'directiva' es DD/DB/RESx, en 'valores' queda el valor.
+    // Sin etiqueta (como dentro de TIMES) la directiva es el propio mnemónico.
+    string_view etiqueta = l.mnemonico;
+    string_view directiva = l.directiva;
+    string_view valores = l.valores;
+    if (es_directiva_datos(l.mnemonico)) {
+        etiqueta = string_view();
+        directiva = l.mnemonico;
+        valores = l.resto;
+    }
+    if (!etiqueta.empty()) {
+        if (!es_directiva_datos(directiva) && !iguales_ci(directiva, "TIMES") && !iguales_ci(directiva, "INCBIN")) {
+            // Si falla todo, es una instrucción o directiva realmente no soportada.
+            advertencias() << "Advertencia: Mnemónico o directiva no soportada: " << l.mnemonico << endl;
+            return;
+        }
+        procesar_etiqueta(etiqueta);
+    }
+
+    uint32_t unidad = 0;
+    if (iguales_ci(directiva, "RESB")) unidad = 1;
+    else if (iguales_ci(directiva, "RESW")) unidad = 2;
+    else if (iguales_ci(directiva, "RESD")) unidad = 4;
+    else if (iguales_ci(directiva, "RESQ")) unidad = 8;
+    if (unidad != 0) {
+        reservar(directiva, valores, unidad);
+        return;
+    }
+    if (iguales_ci(directiva, "TIMES")) {
+        procesar_times(valores);
+        return;
+    }
+    if (iguales_ci(directiva, "INCBIN")) {
+        procesar_incbin(valores);
+        return;
+    }
+
+    if (seccion_actual == Seccion::Bss) {
+        // Como NASM: se reserva el espacio y los valores se descartan
+        advertencias() << "Advertencia: datos inicializados en .bss; se ignoran los valores de "
+                  << (etiqueta.empty() ? directiva : etiqueta) << endl;
+    }
+    if (seccion_actual == Seccion::Heredada) heredada_inicializada = true;
+
+    // valores = "5, 2, 8, 1, 9, 3"
+    const bool dd = iguales_ci(directiva, "DD");
+    while (!valores.empty()) {
+        size_t coma = valores.find(',');
+        string_view token = recortar(valores.substr(0, coma));
+        valores = (coma == string_view::npos) ? string_view() : valores.substr(coma + 1);
+        if (token.empty()) continue;
+
+        uint32_t val;
+        if (!obtener_inmediato32(token, val)) {
+            errores() << "Error en " << (dd ? "DD" : "DB") << ": valor invalido '" << token << "'\n";
+            val = 0;
+        }
+        if (dd) {
+            agregar_dword(val);
+        } else {
+            // Como NASM: de -128 a 255; fuera de eso se avisa y se trunca
+            if (val > 0xFF && val < 0xFFFFFF80u) {
+                advertencias() << "Advertencia en DB: '" << token << "' no cabe en un byte; se trunca\n";
+            }
+            agregar_byte(static_cast<uint8_t>(val));
+        }
+    }
+}
+
+// INCBIN "archivo"[, desplazamiento[, largo]]: el archivo se proyecta en
+// memoria y la parte pedida se copia de una sola vez a la sección
+void EnsambladorIA32::procesar_incbin(string_view argumentos) {
+    argumentos = recortar(argumentos);
+    const size_t cierre = argumentos.empty() ? string_view::npos : argumentos.find(argumentos[0], 1);
+    if (cierre == string_view::npos || (argumentos[0] != '"' && argumentos[0] != '\'')) {
+        errores() << "Error en INCBIN: se esperaba un nombre de archivo entre comillas: " << argumentos << endl;
+        return;
+    }
+    const string ruta(argumentos.substr(1, cierre - 1));
+
+    uint32_t desplazamiento = 0;
+    uint32_t largo = 0xFFFFFFFFu;   // hasta el final del archivo
+    string_view resto = recortar(argumentos.substr(cierre + 1));
+    if (!resto.empty()) {
+        size_t coma = resto.find(',', 1);
+        bool ok = resto[0] == ',' && obtener_inmediato32(recortar(resto.substr(1, coma - 1)), desplazamiento);
+        if (ok && coma != string_view::npos) ok = obtener_inmediato32(recortar(resto.substr(coma + 1)), largo);
+        if (!ok) {
+            errores() << "Error en INCBIN: desplazamiento o largo invalido: " << resto << endl;
+            return;
+        }
+    }
+
+    depende_de_archivos = true;
+    ArchivoFuente archivo;
+    if (ruta == "-" || !archivo.abrir(ruta)) {
+        errores() << "Error en INCBIN: no se pudo abrir el archivo: " << ruta << endl;
+        return;
+    }
+    string_view contenido = archivo.contenido();
+    if (desplazamiento > contenido.size()) {
+        errores() << "Error en INCBIN: el desplazamiento " << desplazamiento << " excede el tamano de " << ruta << endl;
+        return;
+    }
+    contenido = contenido.substr(desplazamiento, largo);
+    if (static_cast<uint64_t>(contador_posicion) + contenido.size() > 0x7FFFFFFFu) {
+        errores() << "Error en INCBIN: " << ruta << " excede el espacio de direcciones" << endl;
+        return;
+    }
+
+    if (seccion_actual == Seccion::Bss) {
+        advertencias() << "Advertencia: datos inicializados en .bss; se ignora el contenido de " << ruta << endl;
+    }
+    if (seccion_actual == Seccion::Heredada) heredada_inicializada = true;
+    if (codigo_actual != nullptr) codigo_actual->insert(codigo_actual->end(), contenido.begin(), contenido.end());
+    contador_posicion += static_cast<int>(contenido.size());
+}
+
+// TIMES n <instrucción o datos>: la línea se ensambla una sola vez y luego
+// se replican sus bytes, sus referencias y sus saltos relajables.
+void EnsambladorIA32::procesar_times(string_view argumentos) {
+    string_view repetida;
+    string_view cuenta = primer_token(argumentos, repetida);
+    uint32_t n;
+    if (!obtener_inmediato32(cuenta, n)) {
+        errores() << "Error en TIMES: cantidad invalida '" << cuenta << "'" << endl;
+        return;
+    }
+
+    LineaLexada l;
+    if (!lexar_linea(repetida, l) || !l.etiqueta.empty()) {
+        errores() << "Error en TIMES: falta la instruccion o los datos a repetir" << endl;
+        return;
+    }
+    const DescriptorInstruccion* desc = buscar_instruccion(l.mnemonico);
+    if (desc != nullptr && desc->forma == FormaInstruccion::Directiva &&
+        !iguales_ci(desc->mnemonico, "TIMES") && !iguales_ci(desc->mnemonico, "INCBIN")) {
+        errores() << "Error en TIMES: no se puede repetir " << desc->mnemonico << endl;
+        return;
+    }
+    if (n == 0) return;
+
+    TramoEmitido tramo = iniciar_tramo();
+    procesar_instruccion(l);
+    // Una etiqueta delante de los datos (x dd 0) se define una sola vez
+    if (cerrar_tramo(tramo, true) && n > 1) replicar_tramo(tramo, n - 1);
+}
+
+// NOP recomendados por Intel para 1 a 9 bytes; huecos mayores repiten el de 9
+static const uint8_t NOPS_MULTIBYTE[9][9] = {
+    {0x90},
+    {0x66, 0x90},
+    {0x0F, 0x1F, 0x00},
+    {0x0F, 0x1F, 0x40, 0x00},
+    {0x0F, 0x1F, 0x44, 0x00, 0x00},
+    {0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00},
+    {0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00},
+    {0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+// Relleno de un ALIGN: pocas instrucciones largas en lugar de muchos 90
+static void escribir_relleno(uint8_t* destino, uint32_t n, bool nops, uint8_t byte) {
+    if (!nops) {
+        memset(destino, byte, n);
+        return;
+    }
+    while (n > 0) {
+        const uint32_t k = min<uint32_t>(n, 9);
+        memcpy(destino, NOPS_MULTIBYTE[k - 1], k);
+        destino += k;
+        n -= k;
+    }
+}
+
+static bool rellena_con_nops(const SaltoRelajable& a, Seccion seccion) {
+    if (a.modo_relleno == RellenoAlineacion::SegunSeccion) return seccion == Seccion::Text;
+    return a.modo_relleno == RellenoAlineacion::Nops;
+}
+
+// ALIGN n[, relleno]: avanza hasta el siguiente múltiplo de n (potencia de
+// 2, hasta 4096). El relleno es NOP (por defecto en .text) o un byte (por
+// defecto 0 fuera de .text). Queda anotado como fragmento variable y la
+// relajación calcula el hueco con las posiciones finales. En la pasada se
+// reserva el peor caso (n - 1 bytes) para que una etiqueta definida antes
+// del ALIGN no se confunda con una definida después.
+void EnsambladorIA32::procesar_align(string_view argumentos) {
+    const size_t coma = argumentos.find(',');
+    const string_view cuenta = recortar(argumentos.substr(0, coma));
+    uint32_t n = 0;
+    if (!obtener_inmediato32(cuenta, n) || n == 0 || n > 4096 || (n & (n - 1)) != 0) {
+        errores() << "Error en ALIGN: se esperaba una potencia de 2 entre 1 y 4096: '" << cuenta << "'" << endl;
+        return;
+    }
+
+    SaltoRelajable a;
+    a.posicion = static_cast<uint32_t>(contador_posicion);
+    a.referencia = SIN_SIMBOLO;
+    a.opcode_largo = 0;
+    a.crecimiento = 0;
+    a.largo = false;
+    a.seccion = seccion_actual;
+    a.alineacion = static_cast<uint16_t>(n);
+    if (coma != string_view::npos) {
+        const string_view relleno = recortar(argumentos.substr(coma + 1));
+        uint32_t byte = 0;
+        if (iguales_ci(relleno, "NOP")) {
+            a.modo_relleno = RellenoAlineacion::Nops;
+        } else if (obtener_inmediato32(relleno, byte) && byte <= 0xFF) {
+            a.modo_relleno = RellenoAlineacion::Byte;
+            a.byte_relleno = static_cast<uint8_t>(byte);
+        } else {
+            errores() << "Error en ALIGN: relleno invalido '" << relleno << "' (byte o NOP)" << endl;
+            return;
+        }
+    }
+    if (n == 1) return;
+
+    const size_t s = static_cast<size_t>(seccion_actual);
+    alineacion_secciones[s] = max(alineacion_secciones[s], n);
+    a.relleno = n - 1;
+    saltos_relajables.push_back(a);
+    if (codigo_actual != nullptr) {
+        codigo_actual->resize(codigo_actual->size() + a.relleno);
+        escribir_relleno(codigo_actual->data() + a.posicion, a.relleno, rellena_con_nops(a, seccion_actual),
+                         a.byte_relleno);
+    }
+    contador_posicion += static_cast<int>(a.relleno);
+}
+
+// Marca el inicio de lo que van a emitir las líneas siguientes
+TramoEmitido EnsambladorIA32::iniciar_tramo() {
+    // Una reescritura pendiente movería bytes de dentro del tramo
+    cortar_optimizacion();
+    TramoEmitido t;
+    t.seccion = seccion_actual;
+    t.inicio = static_cast<uint32_t>(contador_posicion);
+    t.inicio_refs = static_cast<uint32_t>(referencias_pendientes.size());
+    t.inicio_saltos = static_cast<uint32_t>(saltos_relajables.size());
+    t.etiquetas = etiquetas_definidas;
+    t.cambios_seccion = cambios_seccion;
+    return t;
+}
+
+// Completa el tramo. Devuelve false si no se puede replicar: cambió de
+// sección o, sin 'admite_etiquetas', definió etiquetas (que cada copia
+// volvería a definir en otra posición).
+bool EnsambladorIA32::cerrar_tramo(TramoEmitido& t, bool admite_etiquetas) {
+    cortar_optimizacion();
+    if (cambios_seccion != t.cambios_seccion) return false;
+    if (!admite_etiquetas && etiquetas_definidas != t.etiquetas) return false;
+    t.tamano = static_cast<uint32_t>(contador_posicion) - t.inicio;
+    t.num_refs = static_cast<uint32_t>(referencias_pendientes.size()) - t.inicio_refs;
+    t.num_saltos = static_cast<uint32_t>(saltos_relajables.size()) - t.inicio_saltos;
+    return true;
+}
+
+// Añade 'veces' copias del tramo al final de su sección, que debe ser la
+// actual. Los bytes se copian una vez desde el tramo y después duplicando
+// el bloque ya copiado (log2(veces) copias); cada copia lleva sus propias
+// referencias y saltos, en orden de posición.
+void EnsambladorIA32::replicar_tramo(const TramoEmitido& t, uint32_t veces) {
+    if (t.tamano == 0 || veces == 0) return;
+    cortar_optimizacion();
+    const uint32_t destino = static_cast<uint32_t>(contador_posicion);
+    const uint64_t total = static_cast<uint64_t>(t.tamano) * veces;
+    if (destino + total > 0x7FFFFFFFu) {
+        errores() << "Error: " << total << " bytes repetidos exceden el espacio de direcciones" << endl;
+        return;
+    }
+
+    if (codigo_actual != nullptr) {
+        vector<uint8_t>& codigo = *codigo_actual;
+        codigo.resize(destino + static_cast<size_t>(total));
+        uint8_t* bloque = codigo.data() + destino;
+        memcpy(bloque, codigo.data() + t.inicio, t.tamano);
+        size_t hecho = t.tamano;
+        while (hecho < total) {
+            const size_t copia = min<size_t>(hecho, static_cast<size_t>(total) - hecho);
+            memcpy(bloque + hecho, bloque, copia);
+            hecho += copia;
+        }
+    }
+    contador_posicion = static_cast<int>(destino + total);
+
+    referencias_pendientes.reserve(referencias_pendientes.size() + static_cast<size_t>(t.num_refs) * veces);
+    saltos_relajables.reserve(saltos_relajables.size() + static_cast<size_t>(t.num_saltos) * veces);
+    for (uint32_t k = 0; k < veces; ++k) {
+        const uint32_t desplazamiento = destino - t.inicio + k * t.tamano;
+        const uint32_t base_refs = static_cast<uint32_t>(referencias_pendientes.size());
+        for (uint32_t i = 0; i < t.num_refs; ++i) {
+            ReferenciaPendiente ref = referencias_pendientes[t.inicio_refs + i];
+            ref.posicion += desplazamiento;
+            referencias_pendientes.push_back(ref);
+        }
+        for (uint32_t i = 0; i < t.num_saltos; ++i) {
+            SaltoRelajable salto = saltos_relajables[t.inicio_saltos + i];
+            salto.posicion += desplazamiento;
+            if (salto.alineacion == 0) salto.referencia = base_refs + (salto.referencia - t.inicio_refs);
+            saltos_relajables.push_back(salto);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// ADD, SUB, CMP (generalizado)
+// -----------------------------------------------------------------------------
+void EnsambladorIA32::procesar_binaria(const Instruccion& ins) {
+    const DescriptorInstruccion& desc = *ins.desc;
+    const string_view mnem = desc.mnemonico;
+    const uint8_t opcode_rm_reg = desc.opcode;           // ej: 0x01 (ADD r/m32, r32)
+    const uint8_t opcode_reg_rm = desc.opcode_reg_rm;    // ej: 0x03 (ADD r32, r/m32)
+    const uint8_t opcode_eax_imm = desc.opcode_eax_imm;  // ej: 0x05 (ADD EAX, imm32)
+    const uint8_t opcode_imm_general = desc.opcode_imm;  // ej: 0x81 (ADD r/m32, imm)
+    const uint8_t reg_field_extension = desc.extension;  // ej: 0b000 para ADD, 0b101 para SUB
+
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: Se esperaban 2 operandos para " << mnem << endl;
+        return;
+    }
+    const Operando& dest = ins.dest;
+    const Operando& src = ins.src;
+
+    bool dest_is_reg = dest.tipo == TipoOperando::Registro && dest.tamano == 4;
+    bool src_is_reg = src.tipo == TipoOperando::Registro && src.tamano == 4;
+    bool src_is_imm = src.tipo == TipoOperando::Inmediato;
+    bool dest_is_mem = dest.tipo == TipoOperando::Memoria;
+    bool src_is_mem = src.tipo == TipoOperando::Memoria;
+
+    // 0. BYTE [ETIQUETA], INMEDIATO (80 /extension, imm8); el resto de las
+    //    formas es de 32 bits
+    if (dest_is_mem && dest.tamano == 1 && src_is_imm) {
+        agregar_byte(0x80);
+        codificar_memoria(dest, reg_field_extension);
+        agregar_imm_byte(ins, src);
+        return;
+    }
+    if (!memoria_de_32(ins, dest) || !memoria_de_32(ins, src)) return;
+    
+    // 1. REG, REG (r/m32, r32)
+    if (dest_is_reg && src_is_reg) {
+        agregar_byte(opcode_rm_reg); // ej: 0x01 para ADD, 0x29 para SUB
+        uint8_t modrm = generar_modrm(0b11, src.reg, dest.reg); // MOD=11 (registro), REG=src, R/M=dest
+        agregar_byte(modrm);
+        return;
+    }
+
+    // 2. EAX, INMEDIATO (opcode dedicado). Solo gana si el inmediato no
+    //    cabe en imm8: 83 /ext ib (caso 6) ocupa 3 bytes y este 5
+    if (dest_is_reg && dest.reg == 0b000 && src_is_imm && !usar_forma_imm8(src)) { // EAX, imm
+        agregar_byte(opcode_eax_imm); // ej: 0x05 para ADD, 0x2D para SUB
+        agregar_dword(src.inmediato);
+        return;
+    }
+
+    // 3. REG, [ETIQUETA] (r32, r/m32)
+    if (dest_is_reg && src_is_mem) { 
+        agregar_byte(opcode_reg_rm); // ej: 0x03 para ADD, 0x2B para SUB, 0x3B para CMP
+        // La memoria es la fuente (ModR/M usa REG=dest)
+        codificar_memoria(src, dest.reg);
+        return;
+    }
+    
+    // 4. [ETIQUETA], REG (r/m32, r32)
+    if (dest_is_mem && src_is_reg) { 
+        agregar_byte(opcode_rm_reg); // ej: 0x01 para ADD, 0x29 para SUB, 0x39 para CMP
+        // La memoria es el destino (ModR/M usa REG=src)
+        codificar_memoria(dest, src.reg);
+        return;
+    }
+
+    // 5. [ETIQUETA], INMEDIATO (81 /extension, imm32)
+    // Usaremos la versión IMM8 (0x83 /extension, imm8) si cabe con extensión de signo.
+    if (src_is_imm && dest_is_mem) {
+        const bool imm8 = usar_forma_imm8(src);
+        agregar_byte(imm8 ? 0x83 : opcode_imm_general); // ej: 0x81
+        codificar_memoria(dest, reg_field_extension);
+        agregar_inmediato(src, imm8);
+        return;
+    } 
+    // 6. REG, INMEDIATO (83 /extension, imm8 u 81 /extension, imm32); EAX
+    //    con imm32 ya se manejó
+    if (dest_is_reg && src_is_imm) {
+        const bool imm8 = usar_forma_imm8(src);
+        agregar_byte(imm8 ? 0x83 : opcode_imm_general); // ej: 0x81
+        uint8_t modrm = generar_modrm(0b11, reg_field_extension, dest.reg); // Mod=11 (reg), REG=extensión, R/M=dest
+        agregar_byte(modrm);
+        agregar_inmediato(src, imm8);
+        return;
+    }
+
+
+    errores() << "Error de sintaxis o modo no soportado para " << mnem << ": " << ins.texto << endl;
+}
+// -----------------------------------------------------------------------------
+// IMUL, formas cortas y F7 /ext
+// -----------------------------------------------------------------------------
+void EnsambladorIA32::procesar_imul(const Instruccion& ins) {
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: se esperaban 2 operandos para IMUL." << endl;
+        return;
+    }
+
+    // IMUL r32, r/m32  ->  0F AF /r
+    // Para reg,reg usamos MOD = 11, REG = destino, R/M = fuente
+    if (ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4 &&
+        ins.src.tipo == TipoOperando::Registro && ins.src.tamano == 4) {
+        agregar_byte(0x0F);
+        agregar_byte(0xAF);
+        uint8_t modrm = generar_modrm(0b11, ins.dest.reg, ins.src.reg);
+        agregar_byte(modrm);
+        return;
+    }
+
+    // IMUL r32, imm  ->  6B /r ib o 69 /r id (forma de tres operandos con
+    // el registro como fuente y destino)
+    if (ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4 &&
+        ins.src.tipo == TipoOperando::Inmediato) {
+        const bool imm8 = usar_forma_imm8(ins.src);
+        agregar_byte(imm8 ? 0x6B : 0x69);
+        agregar_byte(generar_modrm(0b11, ins.dest.reg, ins.dest.reg));
+        agregar_inmediato(ins.src, imm8);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para IMUL: " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_registro_corto(const Instruccion& ins) {
+    const DescriptorInstruccion& desc = *ins.desc;
+    if (ins.num_operandos == 1 && ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4) {
+        // Forma corta: opcode+rd
+        // INC r32 -> 40+rd, DEC r32 -> 48+rd, POP r32 -> 58+rd
+        agregar_byte(static_cast<uint8_t>(desc.opcode + ins.dest.reg));
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para " << desc.mnemonico << ": " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_unaria_f7(const Instruccion& ins) {
+    const DescriptorInstruccion& desc = *ins.desc;
+    const Operando& op = ins.dest;
+    if (ins.num_operandos == 1 && op.tipo == TipoOperando::Registro && op.tamano == 4) {
+        // MUL r32 -> F7 /4, DIV r32 -> F7 /6, IDIV r32 -> F7 /7
+        // MOD=11, REG=extensión, R/M=reg
+        agregar_byte(desc.opcode);
+        uint8_t modrm = generar_modrm(0b11, desc.extension, op.reg);
+        agregar_byte(modrm);
+        return;
+    }
+
+    // F7 /ext [MEM], o F6 /ext con BYTE [MEM]
+    if (ins.num_operandos == 1 && op.tipo == TipoOperando::Memoria) {
+        if (op.tamano != 1 && !memoria_de_32(ins, op)) return;
+        agregar_byte(op.tamano == 1 ? 0xF6 : desc.opcode);
+        codificar_memoria(op, desc.extension);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para " << desc.mnemonico << ": " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_push(const Instruccion& ins) {
+    const Operando& op = ins.dest;
+    if (ins.num_operandos != 1) {
+        errores() << "Error de sintaxis o modo no soportado para PUSH: " << ins.texto << endl;
+        return;
+    }
+    
+    // 1. PUSH r32 (50+rd)
+    if (op.tipo == TipoOperando::Registro && op.tamano == 4) {
+        agregar_byte(static_cast<uint8_t>(0x50 + op.reg));
+        return;
+    }
+    
+    // 2. PUSH imm8 (6A ib, con extensión de signo) o imm32 (68 id) - Maneja
+    //    'C', 'B', 'A' y números.
+    if (op.tipo == TipoOperando::Inmediato) {
+        const bool imm8 = usar_forma_imm8(op);
+        agregar_byte(imm8 ? 0x6A : 0x68);
+        agregar_inmediato(op, imm8);
+        return;
+    }
+
+    // 3. PUSH r/m32 (FF /6) - Maneja [EBP+disp] y [ETIQUETA]
+    if (op.tipo == TipoOperando::Memoria) {
+        if (!memoria_de_32(ins, op)) return;
+        agregar_byte(0xFF); // Opcode FF
+        codificar_memoria(op, 0b110); // Extensión /6
+        return;
+    }
+    
+    errores() << "Error de sintaxis o modo no soportado para PUSH: " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_int(const Instruccion& ins) {
+    if (ins.num_operandos == 1 && ins.dest.tipo == TipoOperando::Inmediato && ins.dest.inmediato <= 0xFF) {
+        agregar_byte(0xCD);
+        agregar_byte(static_cast<uint8_t>(ins.dest.inmediato));
+        return;
+    }
+    errores() << "Error: Formato de INT invalido o inmediato fuera de rango (0-255): " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_call(const Instruccion& ins) {
+    if (ins.num_operandos != 1 || ins.dest.tipo != TipoOperando::Etiqueta) {
+        errores() << "Error de sintaxis o modo no soportado para CALL: " << ins.texto << endl;
+        return;
+    }
+
+    agregar_byte(0xE8);  // CALL rel32
+    int posicion_referencia = contador_posicion;
+
+    ReferenciaPendiente ref;
+    ref.posicion = posicion_referencia;
+    ref.tamano_inmediato = 4;
+    ref.tipo_salto = 1; // relativo
+    agregar_referencia(ins.dest.simbolo, ref);
+
+    agregar_dword(0); // placeholder
+}
+
+void EnsambladorIA32::procesar_loop(const Instruccion& ins) {
+    if (ins.num_operandos != 1 || ins.dest.tipo != TipoOperando::Etiqueta) {
+        errores() << "Error de sintaxis o modo no soportado para LOOP: " << ins.texto << endl;
+        return;
+    }
+
+    agregar_byte(0xE2); // LOOP rel8
+    int posicion_referencia = contador_posicion;
+
+    ReferenciaPendiente ref;
+    ref.posicion = posicion_referencia;
+    ref.tamano_inmediato = 1;  // solo 1 byte de desplazamiento
+    ref.tipo_salto = 1;        // relativo
+    agregar_referencia(ins.dest.simbolo, ref);
+
+    agregar_byte(0x00); // placeholder
+}
+
+// -----------------------------------------------------------------------------
+// Saltos
+// -----------------------------------------------------------------------------
+
+// Todo salto a etiqueta se emite en forma corta (opcode + rel8) y se anota
+// como fragmento variable; relajar_saltos() decide al final cuáles crecen.
+void EnsambladorIA32::emitir_salto_relajable(uint32_t etiqueta, uint8_t opcode, uint8_t opcode_largo,
+                                             uint8_t crecimiento) {
+    SaltoRelajable salto;
+    salto.posicion = static_cast<uint32_t>(contador_posicion);
+    salto.referencia = static_cast<uint32_t>(referencias_pendientes.size());
+    salto.opcode_largo = opcode_largo;
+    salto.crecimiento = crecimiento;
+    salto.largo = formas_fijas;     // con formas fijas, siempre rel32
+    salto.seccion = seccion_actual;
+    saltos_relajables.push_back(salto);
+
+    agregar_byte(opcode);
+
+    ReferenciaPendiente ref;
+    ref.posicion = contador_posicion; // El desplazamiento se parchará en esta posición
+    ref.tamano_inmediato = 1;         // rel8 (puede pasar a rel32 al relajar)
+    ref.tipo_salto = 1;               // relativo
+    // Esta línea asegura que 'CALCULAR' entre en el archivo referencias.txt
+    agregar_referencia(etiqueta, ref);
+
+    agregar_byte(0x00); // placeholder
+}
+
+void EnsambladorIA32::procesar_jmp(const Instruccion& ins) {
+    if (ins.num_operandos != 1 || ins.dest.tipo != TipoOperando::Etiqueta) {
+        errores() << "Error de sintaxis o modo no soportado para JMP: " << ins.texto << endl;
+        return;
+    }
+
+    // EB rel8 → E9 rel32 (3 bytes más)
+    emitir_salto_relajable(ins.dest.simbolo, ins.desc->opcode, ins.desc->opcode_largo, 3);
+}
+
+void EnsambladorIA32::procesar_condicional(const Instruccion& ins) {
+    if (ins.num_operandos != 1 || ins.dest.tipo != TipoOperando::Etiqueta) {
+        errores() << "Error de sintaxis o modo no soportado para " << ins.desc->mnemonico << ": " << ins.texto << endl;
+        return;
+    }
+
+    // 7x rel8 → 0F 8x rel32 (4 bytes más), tomados de la tabla
+    emitir_salto_relajable(ins.dest.simbolo, ins.desc->opcode, ins.desc->opcode_largo, 4);
+}
+
+// -----------------------------------------------------------------------------
+// Relajación de saltos
+// -----------------------------------------------------------------------------
+
+// Fragmento variable de una sección durante la relajación
+struct FragmentoRelajable {
+    uint32_t posicion;      // posición original
+    uint32_t original;      // bytes que ocupa en la pasada
+    uint32_t actual;        // bytes que ocupa con la distribución en curso
+    uint32_t alineacion;    // 0 = salto
+    uint32_t salto;         // índice en saltos_relajables (SIN_SIMBOLO = alineación automática)
+};
+
+// Cuánto se movió lo que estaba en 'posicion' (posición original): suma de
+// lo que cambiaron los fragmentos que terminan en 'posicion' o antes
+static int32_t crecimiento_antes(const vector<uint32_t>& fines, const vector<int32_t>& acumulado,
+                                 uint32_t posicion) {
+    auto it = upper_bound(fines.begin(), fines.end(), posicion);
+    return acumulado[it - fines.begin()];
+}
+
+void EnsambladorIA32::relajar_saltos() {
+    relajar_seccion(Seccion::Text);
+    relajar_seccion(Seccion::Data);
+    relajar_seccion(Seccion::Bss);  // solo ALIGN
+}
+
+// Alarga los saltos de la sección cuyo destino no cabe en rel8 y repite hasta
+// que ninguno cambie. En cada vuelta los huecos de ALIGN se recalculan en
+// orden con las posiciones que dejan los fragmentos anteriores. Los saltos
+// solo crecen, así que el proceso siempre termina. Después se reconstruye el
+// contenido de la sección y se desplazan sus etiquetas y referencias.
+void EnsambladorIA32::relajar_seccion(Seccion seccion) {
+    // Fragmentos de esta sección, en orden de posición
+    vector<FragmentoRelajable> fragmentos;
+    for (uint32_t i = 0; i < saltos_relajables.size(); ++i) {
+        const SaltoRelajable& s = saltos_relajables[i];
+        if (s.seccion != seccion) continue;
+        const uint32_t original = s.alineacion != 0 ? s.relleno : 2;
+        fragmentos.push_back({s.posicion, original, s.largo ? 2u + s.crecimiento : original, s.alineacion, i});
+    }
+
+    // Inicios de bucle: etiquetas de la sección a las que salta hacia atrás
+    // un salto posterior. Se alinean con un fragmento de 0 bytes originales.
+    if (alineacion_bucles > 1 && seccion == Seccion::Text) {
+        vector<uint32_t> inicios;
+        for (const FragmentoRelajable& f : fragmentos) {
+            if (f.alineacion != 0) continue;
+            const uint32_t simbolo = referencias_pendientes[saltos_relajables[f.salto].referencia].simbolo;
+            const int destino = tabla_simbolos[simbolo];
+            if (destino >= 0 && seccion_simbolos[simbolo] == seccion && static_cast<uint32_t>(destino) <= f.posicion) {
+                inicios.push_back(static_cast<uint32_t>(destino));
+            }
+        }
+        sort(inicios.begin(), inicios.end());
+        inicios.erase(unique(inicios.begin(), inicios.end()), inicios.end());
+        for (uint32_t pos : inicios) fragmentos.push_back({pos, 0, 0, alineacion_bucles, SIN_SIMBOLO});
+        if (!inicios.empty()) {
+            // A igual posición, el de 0 bytes va primero (está antes del salto)
+            stable_sort(fragmentos.begin(), fragmentos.end(),
+                        [](const FragmentoRelajable& a, const FragmentoRelajable& b) {
+                            if (a.posicion != b.posicion) return a.posicion < b.posicion;
+                            return a.original == 0 && b.original != 0;
+                        });
+            uint32_t& alineacion = alineacion_secciones[static_cast<size_t>(seccion)];
+            alineacion = max(alineacion, alineacion_bucles);
+        }
+    }
+    const size_t n = fragmentos.size();
+    if (n == 0) return;
+
+    bool hay_alineaciones = false;
+    vector<uint32_t> fines(n);
+    for (size_t i = 0; i < n; ++i) {
+        fines[i] = fragmentos[i].posicion + fragmentos[i].original;
+        if (fragmentos[i].alineacion != 0) hay_alineaciones = true;
+    }
+
+    // acumulado[i] = cuánto cambiaron los fragmentos anteriores al i-ésimo
+    vector<int32_t> acumulado(n + 1, 0);
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        int32_t delta = 0;
+        for (size_t i = 0; i < n; ++i) {
+            FragmentoRelajable& f = fragmentos[i];
+            acumulado[i] = delta;
+            if (f.alineacion != 0) f.actual = (0u - (f.posicion + static_cast<uint32_t>(delta))) & (f.alineacion - 1);
+            delta += static_cast<int32_t>(f.actual) - static_cast<int32_t>(f.original);
+        }
+        acumulado[n] = delta;
+
+        for (size_t i = 0; i < n; ++i) {
+            FragmentoRelajable& f = fragmentos[i];
+            if (f.alineacion != 0) continue;
+            SaltoRelajable& s = saltos_relajables[f.salto];
+            if (s.largo) continue;
+
+            const uint32_t simbolo = referencias_pendientes[s.referencia].simbolo;
+            int destino = tabla_simbolos[simbolo];
+            bool alargar = false;
+            if (destino < 0) {
+                // Un símbolo externo puede estar a cualquier distancia; si
+                // no, se avisará al resolver
+                alargar = ambito_simbolos[simbolo] == AmbitoSimbolo::Externo;
+            } else if (seccion_simbolos[simbolo] != seccion) {
+                // La distancia a otra sección depende de cómo se ubiquen
+                alargar = true;
+            } else {
+                int64_t nuevo_destino = destino + crecimiento_antes(fines, acumulado, static_cast<uint32_t>(destino));
+                int64_t siguiente = static_cast<int64_t>(s.posicion) + acumulado[i] + 2;
+                alargar = !cabe_en_rel8(nuevo_destino - siguiente);
+            }
+            if (alargar) {
+                s.largo = true;
+                f.actual = 2u + s.crecimiento;
+                cambio = true;
+            }
+        }
+    }
+
+    // Sin ALIGN y con todos los saltos cortos no hay nada que mover
+    if (!hay_alineaciones && acumulado[n] == 0) return;
+
+    // Reconstruir el contenido con las formas largas y los rellenos finales
+    if (seccion != Seccion::Bss) {
+        vector<uint8_t>& codigo = contenido_secciones[static_cast<size_t>(seccion)];
+        vector<uint8_t> nuevo(codigo.size() + acumulado[n]);
+        uint8_t* q = nuevo.data();
+        size_t origen = 0;
+        for (const FragmentoRelajable& f : fragmentos) {
+            memcpy(q, codigo.data() + origen, f.posicion - origen);
+            q += f.posicion - origen;
+            if (f.alineacion != 0) {
+                // Las alineaciones automáticas rellenan con NOP
+                const bool nops = f.salto == SIN_SIMBOLO || rellena_con_nops(saltos_relajables[f.salto], seccion);
+                const uint8_t byte = f.salto == SIN_SIMBOLO ? 0 : saltos_relajables[f.salto].byte_relleno;
+                escribir_relleno(q, f.actual, nops, byte);
+            } else {
+                const SaltoRelajable& s = saltos_relajables[f.salto];
+                if (!s.largo) {
+                    memcpy(q, codigo.data() + f.posicion, 2);
+                } else if (s.crecimiento == 4) {
+                    q[0] = 0x0F;                                 // Jcc: 0F 8x
+                    q[1] = s.opcode_largo;
+                    memset(q + 2, 0x00, 4);                      // placeholder disp32
+                } else {
+                    q[0] = s.opcode_largo;
+                    memset(q + 1, 0x00, 4);
+                }
+            }
+            q += f.actual;
+            origen = f.posicion + f.original;
+        }
+        memcpy(q, codigo.data() + origen, codigo.size() - origen);
+        codigo.swap(nuevo);
+    }
+    const uint32_t total = static_cast<uint32_t>(acumulado[n]);
+    if (seccion == seccion_actual) contador_posicion += static_cast<int>(total);
+    else tamano_secciones[static_cast<size_t>(seccion)] += total;
+
+    // Desplazar etiquetas y referencias según lo que cambió antes de ellas
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        int& pos = tabla_simbolos[id];
+        if (pos >= 0 && seccion_simbolos[id] == seccion) {
+            pos += crecimiento_antes(fines, acumulado, static_cast<uint32_t>(pos));
+        }
+    }
+    for (ReferenciaPendiente& ref : referencias_pendientes) {
+        if (ref.seccion == static_cast<uint32_t>(seccion)) {
+            ref.posicion += crecimiento_antes(fines, acumulado, ref.posicion);
+        }
+    }
+
+    // El desplazamiento de cada salto queda justo después de su opcode
+    for (size_t i = 0; i < n; ++i) {
+        const FragmentoRelajable& f = fragmentos[i];
+        if (f.alineacion != 0) continue;
+        const SaltoRelajable& s = saltos_relajables[f.salto];
+        const uint32_t inicio = f.posicion + static_cast<uint32_t>(acumulado[i]);
+        ReferenciaPendiente& ref = referencias_pendientes[s.referencia];
+        if (s.largo) {
+            ref.posicion = inicio + (s.crecimiento == 4 ? 2 : 1);
+            ref.tamano_inmediato = 4;
+        } else {
+            ref.posicion = inicio + 1;
+        }
+    }
+}
+
+void EnsambladorIA32::procesar_test(const Instruccion& ins) {
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: se esperaban 2 operandos para TEST." << endl;
+        return;
+    }
+
+    // TEST r/m32, r32 -> 85 /r
+    if (ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4 &&
+        ins.src.tipo == TipoOperando::Registro && ins.src.tamano == 4) {
+        agregar_byte(0x85);
+        uint8_t modrm = generar_modrm(0b11, ins.src.reg, ins.dest.reg);
+        agregar_byte(modrm);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para TEST: " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_mov(const Instruccion& ins) {
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: Se esperaban 2 operandos para MOV." << endl;
+        return;
+    }
+    const Operando& dest = ins.dest;
+    const Operando& src = ins.src;
+
+    bool dest_is_reg = dest.tipo == TipoOperando::Registro && dest.tamano == 4;
+    bool src_is_reg = src.tipo == TipoOperando::Registro && src.tamano == 4;
+    bool src_is_imm = src.tipo == TipoOperando::Inmediato;
+    bool dest_is_mem = dest.tipo == TipoOperando::Memoria;
+    bool src_is_mem = src.tipo == TipoOperando::Memoria;
+
+    // 0. MOV BYTE [MEM], INMEDIATO (C6 /0, imm8); el resto de las formas es
+    //    de 32 bits
+    if (dest_is_mem && dest.tamano == 1 && src_is_imm) {
+        agregar_byte(0xC6);
+        codificar_memoria(dest, 0b000);
+        agregar_imm_byte(ins, src);
+        return;
+    }
+    if (!memoria_de_32(ins, dest) || !memoria_de_32(ins, src)) return;
+    
+    // 1. MOV REG, REG (89 r/m32, r32)
+    if (dest_is_reg && src_is_reg) {
+        agregar_byte(0x89);
+        uint8_t modrm = generar_modrm(0b11, src.reg, dest.reg); 
+        agregar_byte(modrm);
+        return;
+    }
+
+    // 2. MOV REG, INMEDIATO (B8+rd)
+    if (dest_is_reg && src_is_imm) {
+        agregar_byte(0xB8 + dest.reg);
+        agregar_dword(src.inmediato);
+        return;
+    }
+
+    // --- CASO ESPECIAL MOV ECX, LEN (simulación de constante) ---
+    if (dest_is_reg && src.tipo == TipoOperando::Etiqueta && iguales_ci(simbolos.nombre(src.simbolo), "LEN")) {
+        agregar_byte(0xB8 + dest.reg); 
+        agregar_dword(6); // Valor simulado para LEN
+        return;
+    }
+
+    // 2.1. MOV REG, ETIQUETA (B8+rd con la dirección de la etiqueta)
+    if (dest_is_reg && src.tipo == TipoOperando::Etiqueta) {
+        agregar_byte(0xB8 + dest.reg);
+        ReferenciaPendiente ref;
+        ref.posicion = contador_posicion;
+        ref.tamano_inmediato = 4;
+        ref.tipo_salto = 0;
+        agregar_referencia(src.simbolo, ref);
+        agregar_dword(0);
+        return;
+    }
+
+    // 2.5. MOV [DIRECCIÓN], EAX (A3) y MOV EAX, [DIRECCIÓN] (A1): formas del
+    //      acumulador sin ModR/M, un byte menos que 89/8B con disp32
+    const bool dest_absoluta = dest_is_mem && dest.base < 0 && dest.indice < 0;
+    const bool src_absoluta = src_is_mem && src.base < 0 && src.indice < 0;
+    if ((src_is_reg && src.reg == 0b000 && dest_absoluta) || (dest_is_reg && dest.reg == 0b000 && src_absoluta)) {
+        const Operando& mem = dest_absoluta ? dest : src;
+        agregar_byte(dest_absoluta ? 0xA3 : 0xA1);
+        if (mem.simbolo != SIN_SIMBOLO) {
+            ReferenciaPendiente ref;
+            ref.posicion = contador_posicion;
+            ref.tamano_inmediato = 4;
+            ref.tipo_salto = 0;
+            agregar_referencia(mem.simbolo, ref);
+        }
+        agregar_dword(static_cast<uint32_t>(mem.disp));
+        return;
+    }
+    
+    // 3. MOV [MEM], REG (89 r/m32, r32). MEMORIA ES DESTINO.
+    if (dest_is_mem && src_is_reg) {
+        agregar_byte(0x89); 
+        codificar_memoria(dest, src.reg);
+        return;
+    }
+
+    // 4. MOV REG, [MEM] (8B r32, r/m32). MEMORIA ES FUENTE.
+    if (dest_is_reg && src_is_mem) {
+        agregar_byte(0x8B); // Opcode 8B
+        codificar_memoria(src, dest.reg);
+        return;
+    }
+    
+    // 5. MOV [MEM], INMEDIATO (C7 /0, imm32)
+    if (dest_is_mem && src_is_imm) {
+        agregar_byte(0xC7); 
+        codificar_memoria(dest, 0b000);
+        agregar_dword(src.inmediato);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para MOV: " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_movzx(const Instruccion& ins) {
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: se esperaban 2 operandos para MOVZX." << endl;
+        return;
+    }
+
+    if (!(ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4)) {
+        errores() << "Error: MOVZX requiere un registro de 32 bits como destino." << endl;
+        return;
+    }
+
+    // 1. MOVZX r32, r8 (0F B6 /r)
+    if (ins.src.tipo == TipoOperando::Registro && ins.src.tamano == 1) {
+        agregar_byte(0x0F);
+        agregar_byte(0xB6);
+        uint8_t modrm = generar_modrm(0b11, ins.dest.reg, ins.src.reg);
+        agregar_byte(modrm);
+        return;
+    }
+
+    // 2. MOVZX r32, m8 (0F B6 /r) - Maneja BYTE [DISCOS]
+    // La pista de tamaño "BYTE" ya la consumió el parser de operandos.
+    if (ins.src.tipo == TipoOperando::Memoria) {
+        if (ins.src.tamano != 0 && ins.src.tamano != 1) {
+            errores() << "Error: MOVZX solo soporta una fuente de 8 bits: " << ins.texto << endl;
+            return;
+        }
+        agregar_byte(0x0F);
+        agregar_byte(0xB6); // Opcode 0F B6 para 8->32
+        codificar_memoria(ins.src, ins.dest.reg);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para MOVZX: " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_xchg(const Instruccion& ins) {
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: se esperaban 2 operandos para XCHG." << endl;
+        return;
+    }
+
+    if (ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4 &&
+        ins.src.tipo == TipoOperando::Registro && ins.src.tamano == 4) {
+        // XCHG EAX, r32 / XCHG r32, EAX -> 90+rd (un byte)
+        if (ins.dest.reg == 0b000 || ins.src.reg == 0b000) {
+            agregar_byte(static_cast<uint8_t>(0x90 + (ins.dest.reg | ins.src.reg)));
+            return;
+        }
+        // XCHG r/m32, r32 -> 87 /r
+        agregar_byte(0x87);
+        uint8_t modrm = generar_modrm(0b11, ins.src.reg, ins.dest.reg);
+        agregar_byte(modrm);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para XCHG: " << ins.texto << endl;
+}
+
+void EnsambladorIA32::procesar_lea(const Instruccion& ins) {
+    if (ins.num_operandos != 2) {
+        errores() << "Error de sintaxis: se esperaban 2 operandos para LEA." << endl;
+        return;
+    }
+
+    if (!(ins.dest.tipo == TipoOperando::Registro && ins.dest.tamano == 4)) {
+        errores() << "Error: LEA solo soporta destino registro de 32 bits." << endl;
+        return;
+    }
+
+    // LEA r32, m -> 8D /r
+    if (ins.src.tipo == TipoOperando::Memoria) {
+        agregar_byte(0x8D);
+        codificar_memoria(ins.src, ins.dest.reg);
+        return;
+    }
+
+    errores() << "Error de sintaxis o modo no soportado para LEA: " << ins.texto << endl;
+}
+
+// -----------------------------------------------------------------------------
+// Resolución de referencias pendientes
+// -----------------------------------------------------------------------------
+
+// Parchea las referencias [inicio, fin). Cada rango cubre una zona distinta
+// de codigo_hex, así que varios hilos pueden resolver a la vez sin bloqueos.
+void EnsambladorIA32::resolver_rango(size_t inicio, size_t fin, vector<uint32_t>& sin_definir,
+                                     vector<uint32_t>& fuera_de_rango) {
+    uint8_t* codigo = codigo_hex.data();
+
+    for (size_t i = inicio; i < fin; ++i) {
+        const ReferenciaPendiente ref = referencias_pendientes[i];
+        int destino = tabla_simbolos[ref.simbolo];
+        if (destino < 0) {
+            // Las externas las resuelve el enlazador (reubicaciones del ELF)
+            if (ambito_simbolos[ref.simbolo] != AmbitoSimbolo::Externo) sin_definir.push_back(ref.simbolo);
+            continue;
+        }
+
+        uint8_t* p = codigo + ref.posicion;
+
+        // El placeholder trae el sumando (ej. [ARRAY+4])
+        uint32_t sumando = p[0];
+        if (ref.tamano_inmediato == 4) memcpy(&sumando, p, 4);  // little-endian
+
+        uint32_t valor_a_parchear;
+        if (ref.tipo_salto == 0) {
+            // Referencia absoluta → dirección real de la etiqueta
+            valor_a_parchear = static_cast<uint32_t>(destino) + sumando;
+        } else {
+            // Relativo → destino - (posición del siguiente byte)
+            int offset = destino - static_cast<int>(ref.posicion + ref.tamano_inmediato);
+            valor_a_parchear = static_cast<uint32_t>(offset) + sumando;
+        }
+
+        if (ref.tamano_inmediato == 4) {
+            memcpy(p, &valor_a_parchear, 4);
+        } else {
+            // Solo LOOP puede quedar fuera de rango: JMP/Jcc ya se relajaron
+            if (ref.tipo_salto == 1 && !cabe_en_rel8(static_cast<int32_t>(valor_a_parchear))) {
+                fuera_de_rango.push_back(static_cast<uint32_t>(i));
+            }
+            p[0] = static_cast<uint8_t>(valor_a_parchear & 0xFF);
+        }
+    }
+}
+
+void EnsambladorIA32::resolver_referencias_pendientes() {
+    MedicionFase medicion(*this, FaseEnsamblado::Resolucion);
+
+    // Ya vienen ordenadas por posición; se asegura por si algún paso las desordenó
+    auto por_posicion = [](const ReferenciaPendiente& a, const ReferenciaPendiente& b) {
+        return a.posicion < b.posicion;
+    };
+    if (!is_sorted(referencias_pendientes.begin(), referencias_pendientes.end(), por_posicion)) {
+        stable_sort(referencias_pendientes.begin(), referencias_pendientes.end(), por_posicion);
+    }
+
+    // Solo vale la pena repartir entre hilos con muchas referencias
+    const size_t MIN_REFERENCIAS_POR_HILO = 1 << 16;
+    const size_t total = referencias_pendientes.size();
+    size_t num_hilos = max<size_t>(1, thread::hardware_concurrency());
+    num_hilos = max<size_t>(1, min(num_hilos, total / MIN_REFERENCIAS_POR_HILO));
+
+    vector<vector<uint32_t>> sin_definir(num_hilos);
+    vector<vector<uint32_t>> fuera_de_rango(num_hilos);
+    if (num_hilos == 1) {
+        resolver_rango(0, total, sin_definir[0], fuera_de_rango[0]);
+    } else {
+        vector<thread> hilos;
+        size_t por_hilo = (total + num_hilos - 1) / num_hilos;
+        for (size_t h = 0; h < num_hilos; ++h) {
+            size_t ini = min(total, h * por_hilo);
+            size_t fin = min(total, ini + por_hilo);
+            hilos.emplace_back(&EnsambladorIA32::resolver_rango, this, ini, fin,
+                               ref(sin_definir[h]), ref(fuera_de_rango[h]));
+        }
+        for (auto& h : hilos) h.join();
+    }
+
+    // Un error por etiqueta, en orden de aparición
+    vector<bool> reportada(tabla_simbolos.size(), false);
+    for (const auto& lista : sin_definir) {
+        for (uint32_t id : lista) reportada[id] = true;
+    }
+    for (uint32_t id = 0; id < reportada.size(); ++id) {
+        if (reportada[id]) {
+            errores() << "Error: Etiqueta no definida '" << simbolos.nombre(id)
+                 << "'. Referencia no resuelta." << endl;
+        }
+    }
+
+    // Los rangos están en orden, así que los errores también
+    for (const auto& lista : fuera_de_rango) {
+        for (uint32_t i : lista) {
+            const ReferenciaPendiente& r = referencias_pendientes[i];
+            errores() << "Error: salto a '" << simbolos.nombre(r.simbolo) << "' en la posicion "
+                 << r.posicion - 1 << " fuera del rango de rel8 (-128..127)" << endl;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Ensamblado y generación de archivos
+// -----------------------------------------------------------------------------
+
+bool EnsambladorIA32::ensamblar(const string& archivo_entrada, unsigned num_hilos) {
+    // El archivo se proyecta en memoria (o se lee en bloque si es una
+    // tubería / stdin); las líneas son vistas sobre él, sin copias. Con la
+    // proyección, la lectura de las páginas cae en la fase de ensamblado.
+    const uint64_t inicio_lectura = medir_estadisticas ? reloj_ns() : 0;
+    ArchivoFuente f;
+    if (!f.abrir(archivo_entrada)) {
+        reiniciar();
+        errores() << "No se pudo abrir el archivo: " << archivo_entrada << endl;
+        return false;
+    }
+    const uint64_t fin_lectura = medir_estadisticas ? reloj_ns() : 0;
+
+    // ensamblar_memoria() reinicia las estadísticas
+    ensamblar_memoria(f.contenido(), num_hilos);
+    if (medir_estadisticas) registrar_fase(FaseEnsamblado::Lectura, inicio_lectura, fin_lectura);
+    return true;
+}
+
+void EnsambladorIA32::ensamblar_memoria(string_view fuente, unsigned num_hilos) {
+    reiniciar();
+    if (medir_estadisticas) {
+        estadisticas_pasada.lineas = static_cast<uint64_t>(count(fuente.begin(), fuente.end(), '\n'));
+        if (!fuente.empty() && fuente.back() != '\n') ++estadisticas_pasada.lineas;
+        estadisticas_pasada.bytes_fuente = fuente.size();
+    }
+    MedicionFase medicion(*this, FaseEnsamblado::Ensamblado);
+
+    // Macros y %rep abarcan varias líneas y valen para el resto del archivo,
+    // y la optimización mira las instrucciones siguientes: en ambos casos la
+    // fuente se recorre entera y en orden
+    const bool secuencial = optimizacion || usa_preprocesador(fuente);
+    if (!ruta_cache.empty() && !secuencial) {
+        procesar_fuente_incremental(fuente, num_hilos);
+    } else if (num_hilos > 1 && !secuencial) {
+        procesar_fuente_paralelo(fuente, num_hilos);
+    } else {
+        procesar_fuente(fuente);
+    }
+    relajar_saltos();
+    ubicar_secciones();
+}
+
+// Copia el resultado de este ensamblador (usado como trozo) en 'trozo'
+void EnsambladorIA32::extraer_trozo(TrozoEnsamblado& trozo, string mensajes) const {
+    for (size_t i = 0; i < NUM_SECCIONES_TROZO; ++i) {
+        trozo.codigo[i] = contenido_secciones[i];
+        trozo.tamanos[i] = tamano_seccion(static_cast<Seccion>(i));
+    }
+    trozo.seccion_final = seccion_actual;
+    trozo.heredada_inicializada = heredada_inicializada;
+    trozo.depende_de_archivos = depende_de_archivos;
+    trozo.nombres.resize(simbolos.cantidad());
+    for (uint32_t id = 0; id < simbolos.cantidad(); ++id) trozo.nombres[id] = string(simbolos.nombre_fuente(id));
+    trozo.posiciones.assign(tabla_simbolos.begin(), tabla_simbolos.end());
+    trozo.secciones.assign(seccion_simbolos.begin(), seccion_simbolos.end());
+    trozo.ambitos.assign(ambito_simbolos.begin(), ambito_simbolos.end());
+    trozo.referencias.assign(referencias_pendientes.begin(), referencias_pendientes.end());
+    trozo.saltos.assign(saltos_relajables.begin(), saltos_relajables.end());
+    trozo.mensajes = move(mensajes);
+    trozo.con_errores = hubo_errores;
+}
+
+// Ensambla por separado las partes indicadas en 'pendientes'. Cada hilo usa
+// un único EnsambladorIA32 (reiniciado entre partes) y toma la siguiente
+// parte libre de un contador compartido.
+void EnsambladorIA32::ensamblar_trozos(const vector<string_view>& partes, const vector<size_t>& pendientes,
+                                       vector<TrozoEnsamblado>& resultado, unsigned num_hilos, bool fijas) {
+    atomic<size_t> siguiente(0);
+    auto trabajador = [&]() {
+        EnsambladorIA32 trozo;
+        trozo.posiciones_locales = true;
+        trozo.formas_fijas = fijas;
+        ostringstream mensajes;
+        trozo.redirigir_errores(mensajes);
+
+        for (size_t k = siguiente++; k < pendientes.size(); k = siguiente++) {
+            const size_t i = pendientes[k];
+            trozo.reiniciar();
+            mensajes.str(string());
+            trozo.procesar_fuente(partes[i]);
+            trozo.extraer_trozo(resultado[i], mensajes.str());
+        }
+    };
+
+    size_t num = min<size_t>(max(1u, num_hilos), pendientes.size());
+    if (num <= 1) {
+        trabajador();
+        return;
+    }
+    vector<thread> hilos;
+    for (size_t h = 0; h < num; ++h) hilos.emplace_back(trabajador);
+    for (auto& h : hilos) h.join();
+}
+
+// Parte la fuente en trozos de líneas completas y ensambla cada uno en su
+// propio EnsambladorIA32 (contador, etiquetas y referencias locales). Como la
+// codificación no depende de posiciones ya conocidas (los saltos se relajan
+// al final), basta con concatenar los trozos y desplazar lo que apunta a ellos.
+void EnsambladorIA32::procesar_fuente_paralelo(string_view fuente, unsigned num_hilos) {
+    // Por debajo de este tamaño los hilos cuestan más de lo que ahorran
+    const size_t MIN_BYTES_POR_TROZO = 256 * 1024;
+    const size_t n = fuente.size();
+    size_t num_trozos = min<size_t>(num_hilos, n / MIN_BYTES_POR_TROZO);
+    if (num_trozos <= 1) {
+        procesar_fuente(fuente);
+        return;
+    }
+
+    // Cortes en fin de línea
+    vector<string_view> partes;
+    size_t ini = 0;
+    for (size_t t = 1; t < num_trozos; ++t) {
+        size_t corte = max(ini, n * t / num_trozos);
+        const void* salto = memchr(fuente.data() + corte, '\n', n - corte);
+        if (salto == nullptr) break;
+        size_t fin = static_cast<size_t>(static_cast<const char*>(salto) - fuente.data()) + 1;
+        partes.push_back(fuente.substr(ini, fin - ini));
+        ini = fin;
+    }
+    partes.push_back(fuente.substr(ini));
+
+    vector<size_t> todas(partes.size());
+    for (size_t i = 0; i < todas.size(); ++i) todas[i] = i;
+    vector<TrozoEnsamblado> trozos(partes.size());
+    ensamblar_trozos(partes, todas, trozos, num_hilos, formas_fijas);
+
+    // Unir en orden: los mensajes salen igual que en el recorrido secuencial
+    for (const auto& trozo : trozos) unir_trozo(trozo);
+    trozos_ensamblados = trozos.size();
+}
+
+// Cortes definidos por el contenido: un bloque termina tras una línea cuyo
+// hash cumple una condición, así que insertar o borrar líneas solo cambia el
+// bloque afectado y no desplaza los cortes del resto del archivo.
+static vector<string_view> cortar_por_contenido(string_view fuente) {
+    const size_t MIN_LINEAS = 16;
+    const size_t MAX_LINEAS = 1024;
+    const uint32_t MASCARA_CORTE = 63;   // en promedio un corte cada 64 líneas
+
+    vector<string_view> bloques;
+    size_t ini = 0, pos = 0, lineas = 0;
+    uint32_t h = 2166136261u;
+    while (pos < fuente.size()) {
+        char c = fuente[pos++];
+        if (c != '\n') {
+            h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+            continue;
+        }
+        ++lineas;
+        if ((lineas >= MIN_LINEAS && (h & MASCARA_CORTE) == 0) || lineas >= MAX_LINEAS) {
+            bloques.push_back(fuente.substr(ini, pos - ini));
+            ini = pos;
+            lineas = 0;
+        }
+        h = 2166136261u;
+    }
+    if (ini < fuente.size()) bloques.push_back(fuente.substr(ini));
+    return bloques;
+}
+
+// Modo incremental: los bloques cuyo texto ya está en la caché no se vuelven
+// a ensamblar; solo se unen y se resuelven de nuevo las referencias.
+void EnsambladorIA32::procesar_fuente_incremental(string_view fuente, unsigned num_hilos) {
+    vector<string_view> bloques = cortar_por_contenido(fuente);
+
+    CacheTrozos cache;
+    cache.cargar(ruta_cache, formas_fijas ? 1u : 0u);
+
+    vector<TrozoEnsamblado> nuevos(bloques.size());
+    vector<const TrozoEnsamblado*> trozos(bloques.size(), nullptr);
+    vector<size_t> pendientes;
+    for (size_t i = 0; i < bloques.size(); ++i) {
+        uint64_t h = CacheTrozos::hash_bloque(bloques[i]);
+        trozos[i] = cache.buscar(h, bloques[i].size());
+        if (trozos[i] == nullptr) {
+            nuevos[i].hash = h;
+            nuevos[i].largo_fuente = static_cast<uint32_t>(bloques[i].size());
+            pendientes.push_back(i);
+        }
+    }
+
+    ensamblar_trozos(bloques, pendientes, nuevos, num_hilos, formas_fijas);
+    for (size_t i : pendientes) trozos[i] = &nuevos[i];
+    trozos_ensamblados = pendientes.size();
+    trozos_reutilizados = bloques.size() - pendientes.size();
+
+    for (const TrozoEnsamblado* trozo : trozos) unir_trozo(*trozo);
+
+    if (!cache.guardar(ruta_cache, trozos, formas_fijas ? 1u : 0u)) {
+        advertencias() << "Advertencia: no se pudo escribir la cache " << ruta_cache << endl;
+    }
+}
+
+// Añade al final de cada sección el contenido del trozo y traduce sus IDs de
+// etiqueta y posiciones locales a los de este ensamblador (suma de prefijos
+// de tamaños). Lo heredado por el trozo continúa la sección en curso.
+void EnsambladorIA32::unir_trozo(const TrozoEnsamblado& trozo) {
+    const size_t HEREDADA = static_cast<size_t>(Seccion::Heredada);
+    const Seccion destino[NUM_SECCIONES_TROZO] = {Seccion::Text, Seccion::Data, Seccion::Bss, seccion_actual};
+
+    (trozo.con_errores ? errores() : advertencias()) << trozo.mensajes;
+    if (seccion_actual == Seccion::Bss && trozo.heredada_inicializada) {
+        errores() << "Error: instrucciones o datos inicializados en la seccion .bss" << endl;
+    }
+
+    // Lo heredado va antes que lo que el trozo puso en esa misma sección
+    cambiar_seccion(seccion_actual);
+    uint32_t base[NUM_SECCIONES_TROZO];
+    base[HEREDADA] = tamano_secciones[static_cast<size_t>(seccion_actual)];
+    for (size_t i = 0; i < HEREDADA; ++i) {
+        base[i] = tamano_secciones[i];
+        if (destino[i] == seccion_actual) base[i] += trozo.tamanos[HEREDADA];
+    }
+    for (size_t i : {HEREDADA, size_t(0), size_t(1), size_t(2)}) {
+        const size_t d = static_cast<size_t>(destino[i]);
+        if (destino[i] != Seccion::Bss) {
+            contenido_secciones[d].insert(contenido_secciones[d].end(), trozo.codigo[i].begin(), trozo.codigo[i].end());
+        }
+        tamano_secciones[d] += trozo.tamanos[i];
+    }
+    contador_posicion = static_cast<int>(tamano_secciones[static_cast<size_t>(seccion_actual)]);
+    cambiar_seccion(destino[static_cast<size_t>(trozo.seccion_final)]);
+
+    // Internar en el orden local conserva el orden de aparición global
+    vector<uint32_t> id_global(trozo.nombres.size());
+    for (uint32_t id = 0; id < id_global.size(); ++id) {
+        id_global[id] = id_simbolo(trozo.nombres[id]);
+    }
+    for (uint32_t id = 0; id < id_global.size(); ++id) {
+        if (trozo.ambitos[id] != AmbitoSimbolo::Local) ambito_simbolos[id_global[id]] = trozo.ambitos[id];
+        if (trozo.posiciones[id] >= 0) {
+            const size_t s = static_cast<size_t>(trozo.secciones[id]);
+            definir_etiqueta(id_global[id], static_cast<int>(base[s]) + trozo.posiciones[id], destino[s]);
+        }
+    }
+
+    // Lo heredado dentro de .bss no tiene bytes: sus referencias se descartan
+    vector<uint32_t> indice_global(trozo.referencias.size(), 0);
+    for (size_t k = 0; k < trozo.referencias.size(); ++k) {
+        ReferenciaPendiente ref = trozo.referencias[k];
+        if (destino[ref.seccion] == Seccion::Bss) continue;
+        indice_global[k] = static_cast<uint32_t>(referencias_pendientes.size());
+        ref.posicion += base[ref.seccion];
+        ref.seccion = static_cast<uint32_t>(destino[ref.seccion]);
+        ref.simbolo = id_global[ref.simbolo];
+        referencias_pendientes.push_back(ref);
+    }
+    for (SaltoRelajable salto : trozo.saltos) {
+        const size_t s = static_cast<size_t>(salto.seccion);
+        if (salto.alineacion != 0) {
+            // El relleno se calculó con posiciones del trozo: lo corrige la relajación
+            uint32_t& alineacion = alineacion_secciones[static_cast<size_t>(destino[s])];
+            alineacion = max<uint32_t>(alineacion, salto.alineacion);
+        } else if (destino[s] == Seccion::Bss) {
+            continue;
+        } else {
+            salto.referencia = indice_global[salto.referencia];
+        }
+        salto.posicion += base[s];
+        salto.seccion = destino[s];
+        saltos_relajables.push_back(salto);
+    }
+}
+
+void EnsambladorIA32::procesar_fuente(string_view fuente) {
+    // La fuente se procesa en bloques que terminan en fin de línea. Para cada
+    // bloque, el índice estructural (SIMD) da las posiciones de '\n', ';',
+    // ',' y '[' ']', y el recorrido de líneas solo visita esas posiciones.
+    const size_t BLOQUE = 64 * 1024;
+    const char* p = fuente.data();
+    const size_t n = fuente.size();
+
+    size_t ini = 0;
+    while (ini < n) {
+        size_t fin = min(n, ini + BLOQUE);
+        if (fin < n) {
+            // Retroceder hasta el último salto de línea del bloque
+            size_t corte = fin;
+            while (corte > ini && p[corte - 1] != '\n') --corte;
+            if (corte > ini) {
+                fin = corte;
+            } else {
+                // Línea más larga que un bloque: extender hasta su final
+                const char* salto = static_cast<const char*>(memchr(p + fin, '\n', n - fin));
+                fin = salto ? static_cast<size_t>(salto - p) + 1 : n;
+            }
+        }
+
+        const size_t largo = fin - ini;
+        if (indice_estructural.size() < largo) indice_estructural.resize(largo);
+        const size_t cuenta = indexar_estructura(p + ini, largo, indice_estructural.data());
+
+        const char* linea = p + ini;
+        const char* comentario = nullptr;
+        const char* coma = nullptr;
+        int profundidad = 0;
+        for (size_t k = 0; k < cuenta; ++k) {
+            const char* c = p + ini + indice_estructural[k];
+            switch (*c) {
+                case '\n': {
+                    const char* fin_util = comentario ? comentario : c;
+                    procesar_linea_indexada(string_view(linea, static_cast<size_t>(fin_util - linea)), coma);
+                    linea = c + 1;
+                    comentario = nullptr;
+                    coma = nullptr;
+                    profundidad = 0;
+                    break;
+                }
+                case ';':
+                    if (!comentario) comentario = c;
+                    break;
+                case ',':
+                    if (!comentario && !coma && profundidad == 0) coma = c;
+                    break;
+                case '[':
+                    if (!comentario) ++profundidad;
+                    break;
+                default: // ']'
+                    if (!comentario && profundidad > 0) --profundidad;
+                    break;
+            }
+        }
+
+        // Última línea sin salto final
+        if (linea < p + fin) {
+            const char* fin_util = comentario ? comentario : p + fin;
+            procesar_linea_indexada(string_view(linea, static_cast<size_t>(fin_util - linea)), coma);
+        }
+
+        ini = fin;
+    }
+    cerrar_preprocesador();
+    cortar_optimizacion();
+}
+
+bool EnsambladorIA32::generar_reportes(const string& archivo_simbolos, const string& archivo_referencias) {
+    MedicionFase medicion(*this, FaseEnsamblado::Reportes);
+    ofstream sym(archivo_simbolos);
+    sym << "Tabla de Simbolos:\n";
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] < 0) continue;
+        sym << simbolos.nombre(id) << " -> " << tabla_simbolos[id] << '\n';
+    }
+    sym.close();
+
+    ofstream refs(archivo_referencias);
+    refs << "Tabla de Referencias Pendientes:\n";
+    for (const auto& ref : referencias_pendientes) {
+        refs << "Etiqueta: " << simbolos.nombre(ref.simbolo)
+            << ", Posicion: " << ref.posicion
+            << ", Tamano: " << ref.tamano_inmediato
+            << ", Tipo: " << (ref.tipo_salto == 0 ? "ABSOLUTO" : "RELATIVO")
+            << '\n';
+    }
+    refs.close();
+    return !sym.fail() && !refs.fail();
+}
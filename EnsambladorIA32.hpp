@@ -1,117 +1,586 @@
-#ifndef ENSAMBLADOR_IA32_HPP
-#define ENSAMBLADOR_IA32_HPP
-
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <algorithm>
-#include <iomanip>
-#include <cstdint>
-
-using namespace std;
-
-// --- ESTRUCTURAS DE DATOS ---
-// Estructura para almacenar una referencia pendiente
-struct ReferenciaPendiente {
-    int posicion;
-    int tamano_inmediato;
-    int tipo_salto;
-};
-
-class EnsambladorIA32 {
-private:
-    int contador_posicion;
-    unordered_map<string, int> tabla_simbolos;
-    unordered_map<string, vector<ReferenciaPendiente>> referencias_pendientes;
-    vector<uint8_t> codigo_hex;
-
-    unordered_map<string, uint8_t> reg32_map;
-    unordered_map<string, uint8_t> reg8_map;
-
-    // --- MÉTODOS AUXILIARES ---
-    void inicializar_mapas();
-    void limpiar_linea(string& linea);
-    bool es_etiqueta(const string& s);
-    
-    // --- NUEVAS UTILIDADES DE PARSEO ---
-    bool separar_operandos(const string& linea_operandos, string& dest_str, string& src_str);
-    bool obtener_inmediato32(const string& str, uint32_t& immediate);
-
-    bool is_mem_simple_label(const string& s);
-
-    void procesar_linea(string linea);
-    void procesar_etiqueta(const string& etiqueta);
-    void procesar_instruccion(const string& linea);
-
-    // Función generalizada para operaciones binarias (ADD, SUB, CMP, etc.)
-    void procesar_binaria(const string& mnem,
-                          const string& operandos,
-                          uint8_t opcode_rm_reg,
-                          uint8_t opcode_reg_rm,
-                          uint8_t opcode_eax_imm,
-                          uint8_t opcode_imm_general,
-                          uint8_t reg_field_extension);
-
-    // Declaraciones de procesamiento de instrucciones
-    void procesar_mov(const string& operandos);
-    void procesar_add(const string& operandos);
-    void procesar_sub(const string& operandos);
-    void procesar_cmp(const string& operandos);
-    void procesar_imul(const string& operandos);
-    void procesar_inc(const string& operandos);
-    void procesar_dec(const string& operandos);
-    void procesar_mul(const string& operandos);
-    void procesar_div(const string& operandos);
-    void procesar_idiv(const string& operandos);
-    void procesar_xor(const string& operandos);
-    void procesar_and(const string& operandos);
-    void procesar_or(const string& operandos);
-    void procesar_test(const string& operandos);
-    void procesar_movzx(const string& operandos);
-    void procesar_xchg(const string& operandos);
-    void procesar_lea(const string& operandos);
-    void procesar_call(string operandos);
-    void procesar_ret();
-    void procesar_push(const string& operandos);
-    void procesar_pop(const string& operandos);
-    void procesar_loop(string operandos);
-    void procesar_nop();
-    void procesar_jmp(const string& operandos_in); 
-    void procesar_condicional(const string& mnem, const string& operandos); 
-    void procesar_leave();
-
-    // --- UTILIDADES DE CODIFICACIÓN ---
-    uint8_t generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm);
-    void agregar_byte(uint8_t byte);
-    void agregar_dword(uint32_t dword);
-    bool obtener_reg32(const string& op, uint8_t& reg_code);
-    bool obtener_reg8(const string& op, uint8_t& reg_code);   
-    bool procesar_mem_simple(const string& operando,
-                             uint8_t& modrm_byte,
-                             const uint8_t reg_code,
-                             bool es_destino,
-                             uint8_t op_extension = 0);
-
-    bool procesar_mem_sib(const string& operando,
-                          uint8_t& modrm_byte,
-                          const uint8_t reg_code,
-                          bool es_destino);
-                          
-    bool procesar_mem_disp(const string& operando,
-                           uint8_t& modrm_byte,
-                           const uint8_t reg_code,
-                           bool es_destino);
-
-public:
-    EnsambladorIA32();
-
-    void ensamblar(const string& archivo_entrada);
-    void resolver_referencias_pendientes();
-    void generar_hex(const string& archivo_salida);
-    void generar_reportes();
-};
-
-#endif // ENSAMBLADOR_IA32_HPP
+#ifndef ENSAMBLADOR_IA32_HPP
+#define ENSAMBLADOR_IA32_HPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "Lexico.hpp"
+#include "Instrucciones.hpp"
+#include "Arena.hpp"
+#include "Simbolos.hpp"
+
+using namespace std;
+
+// --- ESTRUCTURAS DE DATOS ---
+// Secciones con contador de posición propio. Mientras se ensambla, las
+// posiciones de etiquetas, referencias y saltos son relativas a su sección;
+// al terminar, ubicar_secciones() las pasa a direcciones de la imagen final.
+// Heredada solo la usan los trozos: es lo que va antes de su primer SECTION,
+// que pertenece a la sección en curso al unirlo.
+enum class Seccion : uint8_t {
+    Text,
+    Data,
+    Bss,        // solo avanza el contador: no ocupa memoria ni salida
+    Heredada
+};
+const size_t NUM_SECCIONES_TROZO = 4;
+
+// Estructura para almacenar una referencia pendiente (8 bytes)
+// Los bytes del placeholder guardan el sumando (ej. el +4 de [ARRAY+4]);
+// al resolver se les suma la dirección de la etiqueta.
+struct ReferenciaPendiente {
+    uint32_t posicion;
+    uint32_t simbolo : 25;          // ID de la etiqueta
+    uint32_t seccion : 2;           // Seccion donde está el campo
+    uint32_t tamano_inmediato : 4;  // 1 o 4 bytes
+    uint32_t tipo_salto : 1;        // 0 = absoluto, 1 = relativo
+};
+static_assert(sizeof(ReferenciaPendiente) == 8, "ReferenciaPendiente debe ocupar 8 bytes");
+
+// Con qué se rellena el hueco de un ALIGN
+enum class RellenoAlineacion : uint8_t {
+    SegunSeccion,   // NOP de varios bytes en .text, ceros en el resto
+    Nops,
+    Byte
+};
+
+// Fragmento de tamaño variable. Un salto a etiqueta se emite corto (2 bytes)
+// y la relajación lo alarga a rel32 si el destino queda fuera de rango. Un
+// ALIGN (alineacion != 0) ocupa el relleno calculado en la pasada, que la
+// relajación vuelve a calcular cuando se mueve el código anterior.
+struct SaltoRelajable {
+    uint32_t posicion;      // posición original del opcode corto o del relleno
+    uint32_t referencia;    // índice de su referencia en referencias_pendientes (solo saltos)
+    uint8_t opcode_largo;   // E9 (JMP) o el 8x que sigue al 0F (Jcc)
+    uint8_t crecimiento;    // bytes extra de la forma larga: 3 (JMP) o 4 (Jcc)
+    bool largo;
+    Seccion seccion;
+    uint16_t alineacion = 0;    // potencia de 2; 0 = salto
+    RellenoAlineacion modo_relleno = RellenoAlineacion::SegunSeccion;
+    uint8_t byte_relleno = 0;
+    uint32_t relleno = 0;       // bytes de relleno emitidos en la pasada
+};
+static_assert(sizeof(SaltoRelajable) == 20, "SaltoRelajable no debe tener bytes de relleno");
+
+// Visibilidad de una etiqueta, según las directivas GLOBAL y EXTERN
+enum class AmbitoSimbolo : uint8_t {
+    Local,
+    Global,     // definida aquí y exportada
+    Externo     // definida en otro objeto
+};
+
+// Resultado de ensamblar un trozo de líneas por separado: todo con posiciones
+// relativas al trozo y etiquetas por nombre, listo para unirse al resto o
+// para guardarse en la caché del modo incremental.
+struct TrozoEnsamblado {
+    uint64_t hash = 0;                  // hash del texto fuente del trozo
+    uint32_t largo_fuente = 0;
+    vector<uint8_t> codigo[NUM_SECCIONES_TROZO];    // por Seccion (.bss vacío)
+    uint32_t tamanos[NUM_SECCIONES_TROZO] = {};
+    Seccion seccion_final = Seccion::Heredada;      // en curso al terminar el trozo
+    bool heredada_inicializada = false;             // instrucciones o DD/DB antes de su primer SECTION
+    bool depende_de_archivos = false;               // usa INCBIN: no se guarda en la caché
+    vector<string> nombres;             // por ID local, en orden de aparición y con su grafía
+    vector<int> posiciones;             // por ID local (-1 = no definida)
+    vector<Seccion> secciones;          // por ID local
+    vector<AmbitoSimbolo> ambitos;      // por ID local
+    vector<ReferenciaPendiente> referencias;
+    vector<SaltoRelajable> saltos;
+    string mensajes;                    // errores y advertencias del trozo
+    bool con_errores = false;           // 'mensajes' incluye algún error
+};
+
+// Vista de solo lectura sobre memoria del ensamblador (como std::span de
+// C++20). Válida hasta la siguiente pasada o reiniciar().
+template <typename T>
+struct Vista {
+    const T* datos = nullptr;
+    size_t tamano = 0;
+
+    const T* begin() const { return datos; }
+    const T* end() const { return datos + tamano; }
+    const T& operator[](size_t i) const { return datos[i]; }
+    bool empty() const { return tamano == 0; }
+};
+
+// Lo que emitió un tramo de líneas (TIMES, %rep o una invocación de macro):
+// bytes [inicio, inicio + tamano) de 'seccion' y sus referencias y saltos.
+// Mientras no se relajen los saltos, todo sigue en su sitio y se puede copiar.
+struct TramoEmitido {
+    Seccion seccion = Seccion::Text;
+    uint32_t inicio = 0;
+    uint32_t tamano = 0;
+    uint32_t inicio_refs = 0;
+    uint32_t num_refs = 0;
+    uint32_t inicio_saltos = 0;
+    uint32_t num_saltos = 0;
+    uint32_t etiquetas = 0;     // etiquetas definidas antes del tramo
+    uint32_t cambios_seccion = 0;
+};
+
+// --- PREPROCESADOR (Macros.cpp) ---
+// %macro nombre n ... %endmacro: el cuerpo se guarda como texto; %1..%n son
+// los parámetros, %0 su cantidad y %%nombre una etiqueta propia de cada
+// invocación.
+struct DefinicionMacro {
+    uint32_t num_parametros = 0;
+    string cuerpo;              // líneas sin comentarios, separadas por '\n'
+};
+
+// %macro o %rep abierto: sus líneas se juntan hasta el cierre
+struct BloqueAbierto {
+    bool es_macro = false;
+    uint32_t macro = 0;         // ID en nombres_macros (%macro)
+    uint32_t cantidad = 0;      // %rep: repeticiones; %macro: parámetros
+    uint32_t anidados = 0;      // bloques abiertos dentro de este
+    vector<string_view> lineas; // vistas válidas hasta el cierre
+};
+
+// --- OPTIMIZACIÓN DE MIRILLA (Optimizacion.cpp) ---
+// Reescrituras de -O1 sobre instrucciones ya decodificadas
+enum class ReglaOptimizacion : uint8_t {
+    MovCeroXor,        // MOV r32, 0        -> XOR r32, r32
+    SumaUnoInc,        // ADD/SUB r32, 1    -> INC/DEC r32
+    CmpCeroTest,       // CMP r32, 0        -> TEST r32, r32
+    ImulDesplazamiento,// IMUL r32, 2^k     -> SHL r32, k
+    ImulLea,           // IMUL r32, 3/5/9   -> LEA r32, [r32 + r32*k]
+    MovSumaLea,        // MOV r, s + ADD r, x -> LEA r, [s + x]
+    Cantidad
+};
+constexpr size_t NUM_REGLAS_OPTIMIZACION = static_cast<size_t>(ReglaOptimizacion::Cantidad);
+
+// Banderas que una reescritura necesita muertas (escritas sin leerse
+// antes) para no cambiar el programa
+constexpr uint8_t BANDERA_CF = 1;
+constexpr uint8_t BANDERAS_RESTO = 2;  // ZF, SF, OF, PF, AF
+constexpr uint8_t BANDERAS_TODAS = BANDERA_CF | BANDERAS_RESTO;
+
+// Instrucción ya emitida con su forma optimizada a la espera de saber si
+// las banderas que cambian están muertas. Está al final del código de la
+// sección y solo la siguen instrucciones sin referencias ni saltos.
+struct ReescrituraPendiente {
+    uint32_t posicion = 0;
+    uint8_t largo = 0;          // bytes de la forma original
+    uint8_t largo_nuevo = 0;
+    uint8_t nuevo[8] = {};
+    uint8_t banderas = 0;       // banderas que aún deben morir
+    ReglaOptimizacion regla = ReglaOptimizacion::MovCeroXor;
+};
+
+struct EstadisticasOptimizacion {
+    uint32_t aplicadas[NUM_REGLAS_OPTIMIZACION] = {};
+    uint32_t bytes_ahorrados[NUM_REGLAS_OPTIMIZACION] = {};
+    uint32_t descartadas = 0;   // las banderas podían estar vivas
+};
+
+// --- ESTADÍSTICAS DE LA PASADA (Estadisticas.cpp) ---
+// Fases con tiempo de pared medido si se activan las estadísticas
+enum class FaseEnsamblado : uint8_t {
+    Lectura,        // abrir o proyectar el archivo
+    Ensamblado,     // análisis, codificación, relajación y ubicación
+    Resolucion,     // resolver_referencias_pendientes
+    Salida,         // generar_hex, _binario, _elf, _intel_hex o _srec
+    Reportes,       // generar_reportes
+    Cantidad
+};
+constexpr size_t NUM_FASES_ENSAMBLADO = static_cast<size_t>(FaseEnsamblado::Cantidad);
+
+// "lectura", "ensamblado", "resolucion", "salida" o "reportes"
+const char* nombre_fase(FaseEnsamblado fase);
+
+// Reloj monótono en nanosegundos (el de los tiempos de las fases)
+uint64_t reloj_ns();
+
+// Contadores de una pasada. Los tiempos se toman al entrar y salir de cada
+// fase; inicio 0 = la fase no se ejecutó. El resto se cuenta al pedirlas,
+// recorriendo las tablas ya armadas: mientras se ensambla no se lleva
+// ninguna cuenta.
+struct EstadisticasEnsamblado {
+    uint64_t inicio_ns[NUM_FASES_ENSAMBLADO] = {};
+    uint64_t duracion_ns[NUM_FASES_ENSAMBLADO] = {};
+
+    uint64_t lineas = 0;                // de la fuente, sin expandir macros
+    uint64_t bytes_fuente = 0;
+    uint64_t bytes_emitidos = 0;        // imagen: .text, relleno y .data
+    uint32_t tamano_secciones[3] = {};  // .text, .data y .bss
+
+    // Referencias por tipo (0 = absoluta, 1 = relativa) y tamaño del campo
+    // (0 = 1 byte, 1 = 4 bytes)
+    uint32_t referencias[2][2] = {};
+    uint32_t saltos = 0;                // JMP/Jcc relajables
+    uint32_t saltos_largos = 0;         // de ellos, los que quedaron en rel32
+
+    // Tabla de símbolos y su hash de direccionamiento abierto
+    uint32_t simbolos = 0;
+    uint32_t simbolos_sin_definir = 0;
+    uint32_t casillas_hash = 0;
+    uint64_t sondeos_hash = 0;          // casillas visitadas para encontrar cada símbolo, sumadas
+    uint32_t sondeo_maximo = 0;
+    uint32_t trozos_ensamblados = 0;
+    uint32_t trozos_reutilizados = 0;   // de la caché incremental
+};
+
+// --- ANÁLISIS ESTÁTICO DE RENDIMIENTO (AnalisisEstatico.cpp) ---
+// Procesadores con tabla de latencias y puertos para --analizar
+enum class Microarquitectura : uint8_t {
+    Skylake,
+    Zen2,
+    Silvermont
+};
+
+// "skylake", "zen2" o "silvermont" (sin distinguir mayúsculas)
+bool buscar_microarquitectura(string_view nombre, Microarquitectura& micro);
+
+// Clasificación de un operando, hecha una sola vez por línea
+enum class TipoOperando : uint8_t {
+    Ninguno,
+    Registro,
+    Inmediato,
+    Memoria,
+    Etiqueta,   // nombre suelto: destino de salto, CALL o dirección
+    Invalido
+};
+
+// Registro compacto con todo lo que necesitan los procesar_*
+struct Operando {
+    TipoOperando tipo = TipoOperando::Ninguno;
+    uint8_t tamano = 0;      // en bytes: 1 (r8/BYTE), 4 (r32/DWORD), 0 = sin indicar
+    uint8_t reg = 0;         // código del registro (tipo Registro)
+    int8_t base = -1;        // registro base en memoria (-1 = sin base)
+    int8_t indice = -1;      // registro índice en memoria (-1 = sin índice)
+    uint8_t escala = 1;      // 1, 2, 4 u 8
+    bool imm8 = false;       // el inmediato cabe en imm8 con extensión de signo
+    int32_t disp = 0;        // desplazamiento de memoria
+    uint32_t inmediato = 0;
+    uint32_t simbolo = SIN_SIMBOLO; // ID de la etiqueta (en memoria o suelta)
+};
+
+// Instrucción ya decodificada: descriptor y operandos clasificados
+struct Instruccion {
+    const DescriptorInstruccion* desc = nullptr;
+    Operando dest;
+    Operando src;
+    int num_operandos = 0;
+    string_view texto;       // operandos tal cual, para los mensajes de error
+};
+
+class EnsambladorIA32 {
+private:
+    // El banco de pruebas (BancoPruebas.cpp) mide por separado etapas que
+    // no son públicas: operandos, despacho por línea y relajación
+    friend class BancoEtapas;
+
+    // Posición dentro de la sección en curso
+    int contador_posicion;
+
+    // Bytes y tamaño de cada sección mientras se ensambla. El tamaño de la
+    // sección en curso está en contador_posicion hasta cambiar de sección.
+    Seccion seccion_actual;
+    vector<uint8_t> contenido_secciones[NUM_SECCIONES_TROZO];
+    uint32_t tamano_secciones[NUM_SECCIONES_TROZO];
+    vector<uint8_t>* codigo_actual;     // nullptr en .bss
+
+    // Mayor ALIGN pedido en cada sección (1 = ninguno): el inicio de la
+    // sección en la imagen y en el objeto ELF debe respetarlo
+    uint32_t alineacion_secciones[NUM_SECCIONES_TROZO];
+
+    // Alineación automática de los destinos de saltos hacia atrás en .text
+    // (inicios de bucle); 0 = desactivada
+    uint32_t alineacion_bucles;
+
+    // Tras ubicar_secciones(): dirección de inicio de .text, .data y .bss
+    uint32_t base_secciones[3];
+
+    // En un trozo: hubo instrucciones o DD/DB antes de su primer SECTION
+    bool heredada_inicializada;
+
+    // La pasada leyó otros archivos (INCBIN): su resultado no depende solo
+    // del texto fuente
+    bool depende_de_archivos;
+
+    // Definiciones de etiquetas y cambios de sección hechos en la pasada
+    // (para saber si un tramo se puede replicar)
+    uint32_t etiquetas_definidas;
+    uint32_t cambios_seccion;
+
+    // Memoria temporal de la pasada; debe declararse antes que sus usuarios
+    Arena arena;
+
+    // Etiquetas internadas: definición y referencias indexadas por ID
+    InternadorSimbolos simbolos;
+    VectorArena<int> tabla_simbolos;                      // posición (-1 = no definida)
+    VectorArena<AmbitoSimbolo> ambito_simbolos;           // GLOBAL / EXTERN por ID
+    VectorArena<Seccion> seccion_simbolos;                // sección donde se definió
+
+    // Todas las referencias en un solo arreglo, ordenado por posición
+    VectorArena<ReferenciaPendiente> referencias_pendientes;
+
+    // Saltos JMP/Jcc a etiquetas, en orden de posición dentro de su sección
+    VectorArena<SaltoRelajable> saltos_relajables;
+
+    // Imagen final: .text, .data alineada a 4 y nada de .bss
+    vector<uint8_t> codigo_hex;
+
+    // Posiciones estructurales del bloque en curso (se reutiliza entre bloques)
+    vector<uint32_t> indice_estructural;
+
+    // Preprocesador: macros por ID de nombre, bloques abiertos y, por
+    // invocación (macro y argumentos), lo que emitió la primera vez
+    InternadorSimbolos nombres_macros;
+    vector<DefinicionMacro> macros;
+    vector<BloqueAbierto> bloques_abiertos;
+    unordered_map<string, TramoEmitido> invocaciones;
+    uint32_t num_expansiones;
+    uint32_t profundidad_macros;
+
+    // Optimización de mirilla (-O1): reescrituras a la espera de que mueran
+    // las banderas, cantidad de referencias y saltos al abrir la ventana y
+    // último MOV r32, r32 emitido (para fusionarlo con un ADD en un LEA)
+    bool optimizacion;
+    vector<ReescrituraPendiente> reescrituras;
+    size_t refs_ventana;
+    size_t saltos_ventana;
+    uint32_t posicion_mov_previo;   // SIN_SIMBOLO = no hay
+    uint8_t mov_previo_dest;
+    uint8_t mov_previo_src;
+    EstadisticasOptimizacion estadisticas_opt;
+
+    // Cada instrucción usa siempre la misma forma, sin depender de sus
+    // valores: imm32, disp32 y saltos rel32 (para parchear el código después)
+    bool formas_fijas;
+
+    // Estadísticas (--stats): desactivadas, cada fase cuesta una comparación
+    bool medir_estadisticas;
+    EstadisticasEnsamblado estadisticas_pasada;
+
+    // Mide una fase de principio a fin de su ámbito
+    class MedicionFase {
+    private:
+        EnsambladorIA32& e;
+        FaseEnsamblado fase;
+        uint64_t inicio;
+
+    public:
+        MedicionFase(EnsambladorIA32& ens, FaseEnsamblado f)
+            : e(ens), fase(f), inicio(ens.medir_estadisticas ? reloj_ns() : 0) {}
+        ~MedicionFase() {
+            if (e.medir_estadisticas) e.registrar_fase(fase, inicio, reloj_ns());
+        }
+    };
+    void registrar_fase(FaseEnsamblado fase, uint64_t inicio, uint64_t fin);
+
+    // Mensajes de error y advertencia (cerr salvo que se redirijan). Pedir
+    // errores() marca la pasada como fallida; advertencias() no.
+    ostream* salida_errores;
+    mutable bool hubo_errores;
+    ostream& errores() const {
+        hubo_errores = true;
+        return *salida_errores;
+    }
+    ostream& advertencias() const { return *salida_errores; }
+
+    // En un trozo del ensamblado en paralelo las posiciones son locales al
+    // trozo; las reglas que dependen de la posición global se aplican al unir.
+    bool posiciones_locales;
+
+    // --- MÉTODOS AUXILIARES ---
+    uint32_t id_simbolo(string_view etiqueta);
+    void agregar_referencia(uint32_t simbolo, ReferenciaPendiente ref);
+    void resolver_rango(size_t inicio, size_t fin, vector<uint32_t>& sin_definir,
+                        vector<uint32_t>& fuera_de_rango);
+
+    // --- NUEVAS UTILIDADES DE PARSEO ---
+    bool obtener_inmediato32(string_view str, uint32_t& immediate);
+    bool parsear_operando(string_view texto, Operando& op);
+    bool parsear_memoria(string_view interior, Operando& op);
+
+    void procesar_fuente(string_view fuente);
+    void procesar_linea(string_view linea);
+    void procesar_linea_indexada(string_view linea, const char* coma);
+    void procesar_lexada(const LineaLexada& linea);
+    void procesar_etiqueta(string_view etiqueta);
+    void definir_etiqueta(uint32_t id, int posicion, Seccion seccion);
+    void declarar_simbolos(string_view lista, AmbitoSimbolo ambito);
+    void procesar_instruccion(const LineaLexada& linea);
+    void emitir_instruccion(const Instruccion& ins);
+    void procesar_datos(const LineaLexada& linea);
+    void procesar_section(string_view nombre);
+    void reservar(string_view directiva, string_view cuenta, uint32_t tamano_unidad);
+    void procesar_incbin(string_view argumentos);
+    void procesar_times(string_view argumentos);
+    void procesar_align(string_view argumentos);
+
+    // --- REPLICACIÓN DE TRAMOS ---
+    TramoEmitido iniciar_tramo();
+    bool cerrar_tramo(TramoEmitido& t, bool admite_etiquetas);
+    void replicar_tramo(const TramoEmitido& t, uint32_t veces);
+
+    // --- PREPROCESADOR (Macros.cpp) ---
+    static bool usa_preprocesador(string_view fuente);
+    bool preprocesar_linea(string_view linea);
+    void procesar_directiva_pre(string_view linea);
+    void ejecutar_bloque(const BloqueAbierto& bloque);
+    bool expandir_macro(const LineaLexada& linea);
+    void cerrar_preprocesador();
+
+    // --- OPTIMIZACIÓN DE MIRILLA (Optimizacion.cpp) ---
+    void optimizar_instruccion(const Instruccion& ins);
+    void codificar_aparte(const Instruccion& ins, ReescrituraPendiente& r);
+    void agregar_reescritura(const ReescrituraPendiente& r);
+    void aplicar_reescrituras(uint8_t banderas_escritas);
+    void cortar_optimizacion();
+
+    // --- SECCIONES ---
+    void cambiar_seccion(Seccion nueva);
+    uint32_t tamano_seccion(Seccion s) const;
+    void ubicar_secciones();
+
+    // Función generalizada para operaciones binarias (ADD, SUB, CMP, etc.)
+    void procesar_binaria(const Instruccion& ins);
+
+    // Declaraciones de procesamiento de instrucciones
+    void procesar_mov(const Instruccion& ins);
+    void procesar_imul(const Instruccion& ins);
+    void procesar_registro_corto(const Instruccion& ins);
+    void procesar_unaria_f7(const Instruccion& ins);
+    void procesar_test(const Instruccion& ins);
+    void procesar_movzx(const Instruccion& ins);
+    void procesar_xchg(const Instruccion& ins);
+    void procesar_lea(const Instruccion& ins);
+    void procesar_call(const Instruccion& ins);
+    void procesar_push(const Instruccion& ins);
+    void procesar_loop(const Instruccion& ins);
+    void procesar_jmp(const Instruccion& ins);
+    void procesar_condicional(const Instruccion& ins);
+    void procesar_int(const Instruccion& ins);
+
+    // --- RELAJACIÓN DE SALTOS ---
+    void emitir_salto_relajable(uint32_t etiqueta, uint8_t opcode, uint8_t opcode_largo, uint8_t crecimiento);
+    void relajar_seccion(Seccion seccion);
+    void relajar_saltos();
+
+    // --- ENSAMBLADO POR TROZOS (PARALELO E INCREMENTAL) ---
+    string ruta_cache;
+    size_t trozos_reutilizados;
+    size_t trozos_ensamblados;
+
+    void extraer_trozo(TrozoEnsamblado& trozo, string mensajes) const;
+    static void ensamblar_trozos(const vector<string_view>& partes, const vector<size_t>& pendientes,
+                                 vector<TrozoEnsamblado>& resultado, unsigned num_hilos, bool fijas);
+    void procesar_fuente_paralelo(string_view fuente, unsigned num_hilos);
+    void procesar_fuente_incremental(string_view fuente, unsigned num_hilos);
+    void unir_trozo(const TrozoEnsamblado& trozo);
+
+    // --- UTILIDADES DE CODIFICACIÓN ---
+    uint8_t generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm);
+    void agregar_byte(uint8_t byte);
+    void agregar_dword(uint32_t dword);
+    void agregar_inmediato(const Operando& op, bool usar_imm8);
+    bool usar_forma_imm8(const Operando& op) const;
+    bool obtener_reg32(string_view op, uint8_t& reg_code);
+    bool obtener_reg8(string_view op, uint8_t& reg_code);
+
+    // ModR/M (+ SIB + desplazamiento) para un operando de memoria ya parseado
+    void codificar_memoria(const Operando& mem, uint8_t reg_field);
+    // Pista BYTE/WORD de una memoria en forma de 32 bits: error y false
+    bool memoria_de_32(const Instruccion& ins, const Operando& op);
+    void agregar_imm_byte(const Instruccion& ins, const Operando& op);
+
+public:
+    EnsambladorIA32();
+
+    // Deja el ensamblador listo para otra pasada, reutilizando la arena
+    void reiniciar();
+    const Arena& memoria() const { return arena; }
+
+    void redirigir_errores(ostream& salida) { salida_errores = &salida; }
+
+    // true si la pasada (o la generación de salidas posterior) informó
+    // algún error; las advertencias no cuentan
+    bool con_errores() const { return hubo_errores; }
+
+    // Modo incremental: reutiliza de 'ruta' los trozos cuyo texto no cambió
+    // y guarda allí los de esta pasada. Cadena vacía = desactivado.
+    void usar_cache(const string& ruta) { ruta_cache = ruta; }
+
+    // -O1: reescribe instrucciones a formas equivalentes más cortas o
+    // rápidas cuando las banderas que cambian no se leen después. Obliga a
+    // ensamblar en orden, sin trozos.
+    void usar_optimizacion(bool activar) { optimizacion = activar; }
+    const EstadisticasOptimizacion& estadisticas_optimizacion() const { return estadisticas_opt; }
+
+    // Por defecto cada instrucción toma su codificación más corta (imm8,
+    // disp8 o sin desplazamiento, formas del acumulador y de registro,
+    // saltos rel8). Con formas fijas el tamaño no depende de los valores:
+    // inmediatos imm32, desplazamientos disp32 y saltos rel32, para poder
+    // parchear el código después. Desactiva -O1.
+    void usar_formas_fijas(bool activar) { formas_fijas = activar; }
+
+    // Alinea a 'alineacion' bytes (potencia de 2; 0 = no) cada etiqueta de
+    // .text a la que salta hacia atrás un salto posterior, rellenando con
+    // NOP de varios bytes. Equivale a un ALIGN delante de cada bucle.
+    void alinear_bucles(uint32_t alineacion) { alineacion_bucles = alineacion; }
+    void informe_optimizacion(ostream& salida) const;
+
+    // Tiempo por fase y contadores de la pasada (--stats). Los contadores se
+    // calculan en cada llamada; conviene pedirlos tras resolver.
+    void usar_estadisticas(bool activar) { medir_estadisticas = activar; }
+    EstadisticasEnsamblado estadisticas() const;
+    void informe_estadisticas(ostream& salida) const;
+    size_t num_trozos_reutilizados() const { return trozos_reutilizados; }
+    size_t num_trozos_ensamblados() const { return trozos_ensamblados; }
+
+    // Con num_hilos > 1 las fuentes grandes se parten en trozos que se
+    // ensamblan en paralelo; el resultado es idéntico al secuencial.
+    // Devuelve false si no se pudo leer el archivo
+    bool ensamblar(const string& archivo_entrada, unsigned num_hilos = 1);
+
+    // Igual que ensamblar() pero sobre un buffer del llamador, sin tocar el
+    // sistema de archivos. El buffer solo tiene que vivir durante la llamada.
+    void ensamblar_memoria(string_view fuente, unsigned num_hilos = 1);
+    void resolver_referencias_pendientes();
+
+    // --- RESULTADOS EN MEMORIA ---
+    Vista<uint8_t> codigo() const { return {codigo_hex.data(), codigo_hex.size()}; }
+    Vista<ReferenciaPendiente> referencias() const {
+        return {referencias_pendientes.data(), referencias_pendientes.size()};
+    }
+    // Etiquetas por ID, en orden de aparición; posición -1 = no definida
+    size_t num_simbolos() const { return tabla_simbolos.size(); }
+    string_view nombre_simbolo(uint32_t id) const { return simbolos.nombre(id); }
+    int posicion_simbolo(uint32_t id) const { return tabla_simbolos[id]; }
+
+    // Secciones de la imagen (Text, Data o Bss): .text empieza en 0 y .bss
+    // no está en codigo()
+    uint32_t inicio_seccion(Seccion s) const { return base_secciones[static_cast<size_t>(s)]; }
+    uint32_t tamano_bss() const { return tamano_secciones[static_cast<size_t>(Seccion::Bss)]; }
+    uint32_t alineacion_seccion(Seccion s) const { return alineacion_secciones[static_cast<size_t>(s)]; }
+
+    // Formatos de texto (FormatosSalida.cpp): volcado hexadecimal de 16 bytes
+    // por línea, Intel HEX y Motorola S-record, con el código en la dirección 0
+    bool generar_hex(const string& archivo_salida);
+    bool generar_intel_hex(const string& archivo_salida);
+    bool generar_srec(const string& archivo_salida);
+
+    // Formatos binarios (FormatosSalida.cpp), tras resolver las referencias:
+    // imagen plana del código y objeto ELF32 reubicable para ld -m elf_i386
+    bool generar_binario(const string& archivo_salida);
+    bool generar_elf(const string& archivo_salida);
+    bool generar_reportes(const string& archivo_simbolos = "simbolos.txt",
+                          const string& archivo_referencias = "referencias.txt");
+
+    // Análisis estático de .text tras resolver las referencias: bloques
+    // básicos con ciclos por iteración estimados, cadena de dependencias
+    // crítica y presión por puerto según el modelo de 'micro'
+    bool generar_analisis(const string& archivo_salida, Microarquitectura micro) const;
+};
+
+#endif // ENSAMBLADOR_IA32_HPP
@@ -0,0 +1,91 @@
+#include "EnsambladorIA32.hpp"
+
+#include <chrono>
+
+using namespace std;
+
+// --- ESTADÍSTICAS DE LA PASADA ---
+// Durante el ensamblado solo se toman los tiempos de cada fase (y solo si
+// están activadas). Referencias, saltos y símbolos se cuentan al pedir las
+// estadísticas, sobre las tablas que el ensamblador ya tiene.
+
+static const char* const NOMBRES_FASES[NUM_FASES_ENSAMBLADO] = {
+    "lectura", "ensamblado", "resolucion", "salida", "reportes"
+};
+
+const char* nombre_fase(FaseEnsamblado fase) {
+    return NOMBRES_FASES[static_cast<size_t>(fase)];
+}
+
+uint64_t reloj_ns() {
+    return static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Una fase puede repetirse (varios formatos de salida): se suman las
+// duraciones y se conserva el primer inicio
+void EnsambladorIA32::registrar_fase(FaseEnsamblado fase, uint64_t inicio, uint64_t fin) {
+    const size_t f = static_cast<size_t>(fase);
+    if (estadisticas_pasada.inicio_ns[f] == 0) estadisticas_pasada.inicio_ns[f] = inicio;
+    estadisticas_pasada.duracion_ns[f] += fin - inicio;
+}
+
+EstadisticasEnsamblado EnsambladorIA32::estadisticas() const {
+    EstadisticasEnsamblado e = estadisticas_pasada;
+
+    e.bytes_emitidos = codigo_hex.size();
+    for (size_t s = 0; s < 3; ++s) e.tamano_secciones[s] = tamano_seccion(static_cast<Seccion>(s));
+
+    for (const ReferenciaPendiente& r : referencias_pendientes) {
+        ++e.referencias[r.tipo_salto][r.tamano_inmediato == 1 ? 0 : 1];
+    }
+    for (const SaltoRelajable& s : saltos_relajables) {
+        if (s.alineacion != 0) continue; // ALIGN
+        ++e.saltos;
+        if (s.largo) ++e.saltos_largos;
+    }
+
+    e.simbolos = static_cast<uint32_t>(tabla_simbolos.size());
+    for (int posicion : tabla_simbolos) {
+        if (posicion < 0) ++e.simbolos_sin_definir;
+    }
+    simbolos.medir_sondeos(e.casillas_hash, e.sondeos_hash, e.sondeo_maximo);
+    e.trozos_ensamblados = static_cast<uint32_t>(trozos_ensamblados);
+    e.trozos_reutilizados = static_cast<uint32_t>(trozos_reutilizados);
+    return e;
+}
+
+void EnsambladorIA32::informe_estadisticas(ostream& salida) const {
+    const EstadisticasEnsamblado e = estadisticas();
+    const ios::fmtflags formato = salida.flags();
+    salida << fixed << setprecision(3);
+
+    salida << "Estadisticas: tiempo";
+    uint64_t total = 0;
+    for (size_t f = 0; f < NUM_FASES_ENSAMBLADO; ++f) {
+        if (e.inicio_ns[f] == 0) continue;
+        salida << ' ' << NOMBRES_FASES[f] << ' ' << e.duracion_ns[f] / 1e6 << " ms,";
+        total += e.duracion_ns[f];
+    }
+    salida << " total " << total / 1e6 << " ms" << endl;
+
+    salida << "Estadisticas: " << e.lineas << " lineas, " << e.bytes_fuente << " bytes de fuente, "
+           << e.bytes_emitidos << " bytes emitidos (.text " << e.tamano_secciones[0] << ", .data "
+           << e.tamano_secciones[1] << ", .bss " << e.tamano_secciones[2] << ")";
+    if (e.trozos_ensamblados + e.trozos_reutilizados > 0) {
+        salida << "; trozos: " << e.trozos_ensamblados << " ensamblados, " << e.trozos_reutilizados
+               << " de la cache";
+    }
+    salida << endl;
+
+    salida << "Estadisticas: referencias absolutas " << e.referencias[0][1] << " de 4 bytes y " << e.referencias[0][0]
+           << " de 1 byte, relativas " << e.referencias[1][1] << " de 4 bytes y " << e.referencias[1][0]
+           << " de 1 byte; saltos relajables " << e.saltos << " (" << e.saltos_largos << " largos)" << endl;
+
+    salida << "Estadisticas: " << e.simbolos << " simbolos (" << e.simbolos_sin_definir << " sin definir); hash de "
+           << e.casillas_hash << " casillas, carga "
+           << (e.casillas_hash ? static_cast<double>(e.simbolos) / e.casillas_hash : 0.0) << ", "
+           << (e.simbolos ? static_cast<double>(e.sondeos_hash) / e.simbolos : 0.0)
+           << " sondeos por busqueda, maximo " << e.sondeo_maximo << endl;
+    salida.flags(formato);
+}
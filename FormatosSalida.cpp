@@ -0,0 +1,481 @@
+#include "EnsambladorIA32.hpp"
+#include "ConversionHex.hpp"
+
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Utilidades de escritura
+// -----------------------------------------------------------------------------
+
+// Escribe 'n' bytes de una vez; false si el archivo no se pudo crear
+static bool escribir_archivo(const string& ruta, const void* datos, size_t n) {
+    ofstream f(ruta, ios::binary | ios::trunc);
+    if (!f.is_open()) return false;
+    f.write(static_cast<const char*>(datos), static_cast<streamsize>(n));
+    f.close();
+    return !f.fail();
+}
+
+namespace {
+
+// Buffer de salida little-endian
+struct BufferSalida {
+    vector<uint8_t> datos;
+
+    void u8(uint8_t v) { datos.push_back(v); }
+    void u16(uint16_t v) {
+        u8(static_cast<uint8_t>(v));
+        u8(static_cast<uint8_t>(v >> 8));
+    }
+    void u32(uint32_t v) {
+        u16(static_cast<uint16_t>(v));
+        u16(static_cast<uint16_t>(v >> 16));
+    }
+    void bytes(const void* p, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        datos.insert(datos.end(), b, b + n);
+    }
+    uint32_t alinear(size_t alineacion) {
+        while (datos.size() % alineacion != 0) u8(0);
+        return static_cast<uint32_t>(datos.size());
+    }
+    uint32_t posicion() const { return static_cast<uint32_t>(datos.size()); }
+};
+
+// Tabla de cadenas de ELF: empieza con '\0' y cada nombre termina en '\0'
+struct TablaCadenas {
+    string datos = string(1, '\0');
+
+    uint32_t agregar(string_view s) {
+        uint32_t pos = static_cast<uint32_t>(datos.size());
+        datos.append(s.data(), s.size());
+        datos.push_back('\0');
+        return pos;
+    }
+};
+
+// Constantes de ELF32 / i386 (sin <elf.h>, que no existe fuera de Linux)
+const uint16_t ET_REL = 1;
+const uint16_t EM_386 = 3;
+const uint32_t SHT_PROGBITS = 1, SHT_SYMTAB = 2, SHT_STRTAB = 3, SHT_NOBITS = 8, SHT_REL = 9;
+const uint32_t SHF_WRITE = 0x1, SHF_ALLOC = 0x2, SHF_EXECINSTR = 0x4;
+const uint8_t STB_LOCAL = 0, STB_GLOBAL = 1;
+const uint8_t STT_NOTYPE = 0, STT_SECTION = 3;
+const uint8_t R_386_32 = 1, R_386_PC32 = 2, R_386_8 = 22, R_386_PC8 = 23;
+
+const uint32_t TAM_CABECERA_ELF = 52;
+const uint32_t TAM_CABECERA_SECCION = 40;
+
+// Índices de sección fijos del objeto. .text, .data y .bss van seguidas y en
+// el orden de Seccion, igual que sus símbolos de sección (1, 2 y 3).
+enum : uint16_t {
+    SEC_NULA, SEC_TEXT, SEC_DATA, SEC_BSS, SEC_REL_TEXT, SEC_REL_DATA, SEC_SYMTAB, SEC_STRTAB, SEC_SHSTRTAB,
+    NUM_SECCIONES
+};
+
+struct CabeceraSeccion {
+    uint32_t nombre = 0, tipo = 0, flags = 0, direccion = 0, desplazamiento = 0, tamano = 0;
+    uint32_t enlace = 0, info = 0, alineacion = 0, tam_entrada = 0;
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Volcado hexadecimal (programa.hex)
+// -----------------------------------------------------------------------------
+// Todo el texto se arma en un solo buffer y se escribe de una vez.
+
+bool EnsambladorIA32::generar_hex(const string& archivo_salida) {
+    MedicionFase medicion(*this, FaseEnsamblado::Salida);
+    string texto(largo_hex_texto(codigo_hex.size()), '\0');
+    texto.resize(bytes_a_hex_texto(codigo_hex.data(), codigo_hex.size(), &texto[0]));
+
+    if (!escribir_archivo(archivo_salida, texto.data(), texto.size())) {
+        errores() << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Intel HEX y Motorola S-record
+// -----------------------------------------------------------------------------
+// Ambos son registros de texto con los campos en hexadecimal y una suma de
+// control de un byte. El código empieza en la dirección 0.
+
+namespace {
+
+const size_t BYTES_POR_REGISTRO = 16;
+
+// Escritor de registros sobre un buffer ya reservado
+struct EscritorRegistros {
+    string texto;
+    size_t largo = 0;
+
+    explicit EscritorRegistros(size_t capacidad) : texto(capacidad, '\0') {}
+
+    void caracter(char c) { texto[largo++] = c; }
+    void cadena(const char* s) {
+        while (*s != '\0') caracter(*s++);
+    }
+    void hex(const uint8_t* datos, size_t n) {
+        bytes_a_hex(datos, n, &texto[largo]);
+        largo += 2 * n;
+    }
+
+    // Campos fijos en 'cabecera', luego los datos y la suma de control,
+    // calculada por el llamador a partir de la suma de todos los bytes
+    template <typename SumaControl>
+    void registro(const char* inicio, const uint8_t* cabecera, size_t n_cabecera,
+                  const uint8_t* datos, size_t n, SumaControl suma_control) {
+        cadena(inicio);
+        hex(cabecera, n_cabecera);
+        hex(datos, n);
+        const uint8_t suma = suma_control(sumar_bytes(cabecera, n_cabecera) + sumar_bytes(datos, n));
+        hex(&suma, 1);
+        caracter('\n');
+    }
+
+    string& terminar() {
+        texto.resize(largo);
+        return texto;
+    }
+};
+
+// Intel HEX: complemento a dos de la suma
+uint8_t suma_intel(uint32_t suma) { return static_cast<uint8_t>(0x100 - (suma & 0xFF)); }
+
+// S-record: complemento a uno de la suma
+uint8_t suma_srec(uint32_t suma) { return static_cast<uint8_t>(~suma); }
+
+} // namespace
+
+// Registros de datos de 16 bytes (tipo 00). Cada vez que la dirección cruza
+// un bloque de 64 KiB se emite antes su dirección lineal extendida (tipo 04).
+bool EnsambladorIA32::generar_intel_hex(const string& archivo_salida) {
+    MedicionFase medicion(*this, FaseEnsamblado::Salida);
+    const size_t n = codigo_hex.size();
+    const size_t registros = (n + BYTES_POR_REGISTRO - 1) / BYTES_POR_REGISTRO;
+    // ":LLAAAATT" + datos + "CC\n" por registro, más los de dirección y el final
+    EscritorRegistros salida(registros * (12 + 2 * BYTES_POR_REGISTRO) + (n / 0x10000 + 1) * 16 + 12);
+
+    for (size_t i = 0; i < n; i += BYTES_POR_REGISTRO) {
+        if (i > 0 && i % 0x10000 == 0) {
+            const uint8_t bloque[2] = {static_cast<uint8_t>(i >> 24), static_cast<uint8_t>(i >> 16)};
+            const uint8_t cabecera[4] = {2, 0, 0, 0x04};
+            salida.registro(":", cabecera, 4, bloque, 2, suma_intel);
+        }
+        const size_t largo = min(BYTES_POR_REGISTRO, n - i);
+        const uint8_t cabecera[4] = {static_cast<uint8_t>(largo), static_cast<uint8_t>(i >> 8),
+                                     static_cast<uint8_t>(i), 0x00};
+        salida.registro(":", cabecera, 4, codigo_hex.data() + i, largo, suma_intel);
+    }
+    salida.cadena(":00000001FF\n");
+
+    const string& texto = salida.terminar();
+    if (!escribir_archivo(archivo_salida, texto.data(), texto.size())) {
+        errores() << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return false;
+    }
+    return true;
+}
+
+// Cabecera S0 vacía y registros de datos S1 (direcciones de 16 bits), S2
+// (24 bits) o S3 (32 bits) según el tamaño del código, con el registro de
+// fin correspondiente (S9, S8 o S7).
+bool EnsambladorIA32::generar_srec(const string& archivo_salida) {
+    MedicionFase medicion(*this, FaseEnsamblado::Salida);
+    const size_t n = codigo_hex.size();
+    const size_t bytes_direccion = n <= 0x10000 ? 2 : n <= 0x1000000 ? 3 : 4;
+    const char* tipo_datos = bytes_direccion == 2 ? "S1" : bytes_direccion == 3 ? "S2" : "S3";
+    const char* tipo_fin = bytes_direccion == 2 ? "S9" : bytes_direccion == 3 ? "S8" : "S7";
+
+    const size_t registros = (n + BYTES_POR_REGISTRO - 1) / BYTES_POR_REGISTRO;
+    // "Sn" + cuenta + dirección + datos + suma + '\n' por registro, más S0 y fin
+    const size_t largo_registro = 2 + 2 + 2 * bytes_direccion + 2 + 1;
+    EscritorRegistros salida(registros * (largo_registro + 2 * BYTES_POR_REGISTRO) + 2 * largo_registro + 16);
+
+    // La cuenta incluye dirección, datos y suma de control
+    auto cabecera = [&](uint8_t* c, size_t direccion, size_t largo) {
+        c[0] = static_cast<uint8_t>(bytes_direccion + largo + 1);
+        for (size_t b = 0; b < bytes_direccion; ++b) {
+            c[1 + b] = static_cast<uint8_t>(direccion >> (8 * (bytes_direccion - 1 - b)));
+        }
+        return 1 + bytes_direccion;
+    };
+
+    uint8_t c[5];
+    const uint8_t cabecera_s0[3] = {3, 0, 0};
+    salida.registro("S0", cabecera_s0, 3, nullptr, 0, suma_srec);
+    for (size_t i = 0; i < n; i += BYTES_POR_REGISTRO) {
+        const size_t largo = min(BYTES_POR_REGISTRO, n - i);
+        salida.registro(tipo_datos, c, cabecera(c, i, largo), codigo_hex.data() + i, largo, suma_srec);
+    }
+    salida.registro(tipo_fin, c, cabecera(c, 0, 0), nullptr, 0, suma_srec);
+
+    const string& texto = salida.terminar();
+    if (!escribir_archivo(archivo_salida, texto.data(), texto.size())) {
+        errores() << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Binario plano
+// -----------------------------------------------------------------------------
+
+bool EnsambladorIA32::generar_binario(const string& archivo_salida) {
+    MedicionFase medicion(*this, FaseEnsamblado::Salida);
+    if (!escribir_archivo(archivo_salida, codigo_hex.data(), codigo_hex.size())) {
+        errores() << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Objeto ELF32 reubicable
+// -----------------------------------------------------------------------------
+// .text y .data salen de la imagen ya resuelta y .bss solo declara su tamaño.
+// Las referencias absolutas a etiquetas propias tienen su dirección en la
+// imagen; se pasan a desplazamiento dentro de la sección de la etiqueta y
+// llevan una reubicación R_386_32 contra el símbolo de esa sección. Las
+// relativas dentro de la misma sección quedan resueltas; entre secciones
+// llevan R_386_PC32 contra la sección de destino. Las referencias a
+// etiquetas externas llevan una reubicación contra su símbolo, con el
+// sumando en el propio código (formato REL), ajustado en las relativas por el
+// tamaño del campo. Como en NASM, una etiqueta sin definir que no se declaró
+// EXTERN es un error y no se genera el objeto. Los símbolos llevan la grafía
+// de la fuente: el enlazador distingue mayúsculas.
+
+bool EnsambladorIA32::generar_elf(const string& archivo_salida) {
+    MedicionFase medicion(*this, FaseEnsamblado::Salida);
+    string sin_definir;
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] >= 0 || ambito_simbolos[id] == AmbitoSimbolo::Externo) continue;
+        if (!sin_definir.empty()) sin_definir += ", ";
+        sin_definir += simbolos.nombre_fuente(id);
+    }
+    if (!sin_definir.empty()) {
+        errores() << "Error: no se genera " << archivo_salida << ": etiquetas sin definir ni declarar EXTERN: "
+                  << sin_definir << endl;
+        return false;
+    }
+
+    vector<uint8_t> imagen(codigo_hex.begin(), codigo_hex.end());
+    const uint32_t* base = base_secciones;
+    auto indice = [](Seccion s) { return static_cast<size_t>(s); };
+
+    // --- Tabla de símbolos: nula, secciones, locales y luego globales ---
+    TablaCadenas strtab;
+    BufferSalida symtab;
+    auto agregar_simbolo = [&](uint32_t nombre, uint32_t valor, uint8_t ligadura, uint8_t tipo, uint16_t seccion) {
+        symtab.u32(nombre);
+        symtab.u32(valor);
+        symtab.u32(0);  // tamaño
+        symtab.u8(static_cast<uint8_t>((ligadura << 4) | tipo));
+        symtab.u8(0);
+        symtab.u16(seccion);
+    };
+    agregar_simbolo(0, 0, STB_LOCAL, STT_NOTYPE, 0);
+    for (uint16_t sec = SEC_TEXT; sec <= SEC_BSS; ++sec) agregar_simbolo(0, 0, STB_LOCAL, STT_SECTION, sec);
+    auto simbolo_seccion = [&](Seccion s) { return static_cast<uint32_t>(1 + indice(s)); };
+    auto indice_seccion = [&](Seccion s) { return static_cast<uint16_t>(SEC_TEXT + indice(s)); };
+
+    vector<uint32_t> indice_elf(tabla_simbolos.size(), 0);
+    uint32_t num_simbolos = 4;
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] >= 0 && ambito_simbolos[id] == AmbitoSimbolo::Local) {
+            const Seccion s = seccion_simbolos[id];
+            agregar_simbolo(strtab.agregar(simbolos.nombre_fuente(id)),
+                            static_cast<uint32_t>(tabla_simbolos[id]) - base[indice(s)],
+                            STB_LOCAL, STT_NOTYPE, indice_seccion(s));
+            indice_elf[id] = num_simbolos++;
+        }
+    }
+    const uint32_t primer_global = num_simbolos;
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] >= 0 && ambito_simbolos[id] == AmbitoSimbolo::Local) continue;
+        const bool definido = tabla_simbolos[id] >= 0;
+        const Seccion s = seccion_simbolos[id];
+        agregar_simbolo(strtab.agregar(simbolos.nombre_fuente(id)),
+                        definido ? static_cast<uint32_t>(tabla_simbolos[id]) - base[indice(s)] : 0,
+                        STB_GLOBAL, STT_NOTYPE, definido ? indice_seccion(s) : 0);
+        indice_elf[id] = num_simbolos++;
+    }
+
+    // --- Reubicaciones de .text y .data ---
+    BufferSalida rel[2];
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        const Seccion origen = static_cast<Seccion>(ref.seccion);
+        const uint32_t desplazamiento = ref.posicion - base[indice(origen)];
+        const bool definido = tabla_simbolos[ref.simbolo] >= 0;
+        const bool de_4_bytes = ref.tamano_inmediato == 4;
+        BufferSalida& r = rel[indice(origen)];
+
+        // Sumando del campo: se le resta o suma una cantidad fija
+        uint8_t* p = imagen.data() + ref.posicion;
+        auto ajustar = [&](uint32_t delta) {
+            if (de_4_bytes) {
+                uint32_t sumando;
+                memcpy(&sumando, p, 4);
+                sumando += delta;
+                memcpy(p, &sumando, 4);
+            } else {
+                p[0] = static_cast<uint8_t>(p[0] + delta);
+            }
+        };
+
+        if (definido) {
+            const Seccion destino = seccion_simbolos[ref.simbolo];
+            if (ref.tipo_salto == 1 && destino == origen) continue; // relativa en la misma sección: ya resuelta
+            if (ref.tipo_salto == 0) {
+                ajustar(0 - base[indice(destino)]);
+                r.u32(desplazamiento);
+                r.u32((simbolo_seccion(destino) << 8) | (de_4_bytes ? R_386_32 : R_386_8));
+            } else {
+                // Lo resuelto en la imagen, pasado a S + A - P con S y P por sección
+                ajustar(base[indice(origen)] + desplazamiento - base[indice(destino)]);
+                r.u32(desplazamiento);
+                r.u32((simbolo_seccion(destino) << 8) | (de_4_bytes ? R_386_PC32 : R_386_PC8));
+            }
+            continue;
+        }
+
+        uint8_t tipo;
+        if (ref.tipo_salto == 0) {
+            tipo = de_4_bytes ? R_386_32 : R_386_8;
+        } else {
+            // S + A - P se mide desde el campo; el procesador, desde su final
+            tipo = de_4_bytes ? R_386_PC32 : R_386_PC8;
+            ajustar(0 - ref.tamano_inmediato);
+        }
+        r.u32(desplazamiento);
+        r.u32((indice_elf[ref.simbolo] << 8) | tipo);
+    }
+
+    // --- Nombres de sección ---
+    TablaCadenas shstrtab;
+    CabeceraSeccion secciones[NUM_SECCIONES];
+    secciones[SEC_TEXT].nombre = shstrtab.agregar(".text");
+    secciones[SEC_DATA].nombre = shstrtab.agregar(".data");
+    secciones[SEC_BSS].nombre = shstrtab.agregar(".bss");
+    secciones[SEC_REL_TEXT].nombre = shstrtab.agregar(".rel.text");
+    secciones[SEC_REL_DATA].nombre = shstrtab.agregar(".rel.data");
+    secciones[SEC_SYMTAB].nombre = shstrtab.agregar(".symtab");
+    secciones[SEC_STRTAB].nombre = shstrtab.agregar(".strtab");
+    secciones[SEC_SHSTRTAB].nombre = shstrtab.agregar(".shstrtab");
+
+    // --- Archivo: cabecera, contenidos y cabeceras de sección ---
+    BufferSalida elf;
+    elf.datos.resize(TAM_CABECERA_ELF); // se rellena al final
+
+    // Cada sección se alinea al menos a lo que pidieron sus ALIGN
+    const uint32_t alin_text = max<uint32_t>(16, alineacion_secciones[indice(Seccion::Text)]);
+    const uint32_t alin_data = max<uint32_t>(4, alineacion_secciones[indice(Seccion::Data)]);
+    const uint32_t alin_bss = max<uint32_t>(4, alineacion_secciones[indice(Seccion::Bss)]);
+
+    const uint32_t tam_text = tamano_secciones[indice(Seccion::Text)];
+    CabeceraSeccion& s_text = secciones[SEC_TEXT];
+    s_text.tipo = SHT_PROGBITS;
+    s_text.flags = SHF_ALLOC | SHF_EXECINSTR;
+    s_text.desplazamiento = elf.alinear(alin_text);
+    s_text.tamano = tam_text;
+    s_text.alineacion = alin_text;
+    elf.bytes(imagen.data(), tam_text);
+
+    const uint32_t tam_data = tamano_secciones[indice(Seccion::Data)];
+    CabeceraSeccion& s_data = secciones[SEC_DATA];
+    s_data.tipo = SHT_PROGBITS;
+    s_data.flags = SHF_WRITE | SHF_ALLOC;
+    s_data.desplazamiento = elf.alinear(alin_data);
+    s_data.tamano = tam_data;
+    s_data.alineacion = alin_data;
+    elf.bytes(imagen.data() + base[indice(Seccion::Data)], tam_data);
+
+    CabeceraSeccion& s_bss = secciones[SEC_BSS];
+    s_bss.tipo = SHT_NOBITS;
+    s_bss.flags = SHF_WRITE | SHF_ALLOC;
+    s_bss.desplazamiento = elf.posicion();
+    s_bss.tamano = tamano_secciones[indice(Seccion::Bss)];
+    s_bss.alineacion = alin_bss;
+
+    const uint16_t reubicadas[2] = {SEC_TEXT, SEC_DATA};
+    for (size_t k = 0; k < 2; ++k) {
+        CabeceraSeccion& s_rel = secciones[SEC_REL_TEXT + k];
+        s_rel.tipo = SHT_REL;
+        s_rel.desplazamiento = elf.alinear(4);
+        s_rel.tamano = rel[k].posicion();
+        s_rel.enlace = SEC_SYMTAB;
+        s_rel.info = reubicadas[k];
+        s_rel.alineacion = 4;
+        s_rel.tam_entrada = 8;
+        elf.bytes(rel[k].datos.data(), rel[k].datos.size());
+    }
+
+    CabeceraSeccion& s_sym = secciones[SEC_SYMTAB];
+    s_sym.tipo = SHT_SYMTAB;
+    s_sym.desplazamiento = elf.alinear(4);
+    s_sym.tamano = symtab.posicion();
+    s_sym.enlace = SEC_STRTAB;
+    s_sym.info = primer_global;
+    s_sym.alineacion = 4;
+    s_sym.tam_entrada = 16;
+    elf.bytes(symtab.datos.data(), symtab.datos.size());
+
+    CabeceraSeccion& s_str = secciones[SEC_STRTAB];
+    s_str.tipo = SHT_STRTAB;
+    s_str.desplazamiento = elf.posicion();
+    s_str.tamano = static_cast<uint32_t>(strtab.datos.size());
+    s_str.alineacion = 1;
+    elf.bytes(strtab.datos.data(), strtab.datos.size());
+
+    CabeceraSeccion& s_shstr = secciones[SEC_SHSTRTAB];
+    s_shstr.tipo = SHT_STRTAB;
+    s_shstr.desplazamiento = elf.posicion();
+    s_shstr.tamano = static_cast<uint32_t>(shstrtab.datos.size());
+    s_shstr.alineacion = 1;
+    elf.bytes(shstrtab.datos.data(), shstrtab.datos.size());
+
+    const uint32_t inicio_secciones = elf.alinear(4);
+    for (const CabeceraSeccion& s : secciones) {
+        elf.u32(s.nombre);
+        elf.u32(s.tipo);
+        elf.u32(s.flags);
+        elf.u32(s.direccion);
+        elf.u32(s.desplazamiento);
+        elf.u32(s.tamano);
+        elf.u32(s.enlace);
+        elf.u32(s.info);
+        elf.u32(s.alineacion);
+        elf.u32(s.tam_entrada);
+    }
+
+    BufferSalida cabecera;
+    const uint8_t identificacion[16] = {0x7F, 'E', 'L', 'F', 1 /* 32 bits */, 1 /* little-endian */, 1 /* versión */};
+    cabecera.bytes(identificacion, sizeof(identificacion));
+    cabecera.u16(ET_REL);
+    cabecera.u16(EM_386);
+    cabecera.u32(1);                    // versión
+    cabecera.u32(0);                    // punto de entrada
+    cabecera.u32(0);                    // sin cabeceras de programa
+    cabecera.u32(inicio_secciones);
+    cabecera.u32(0);                    // flags
+    cabecera.u16(TAM_CABECERA_ELF);
+    cabecera.u16(0);
+    cabecera.u16(0);
+    cabecera.u16(TAM_CABECERA_SECCION);
+    cabecera.u16(NUM_SECCIONES);
+    cabecera.u16(SEC_SHSTRTAB);
+    memcpy(elf.datos.data(), cabecera.datos.data(), TAM_CABECERA_ELF);
+
+    if (!escribir_archivo(archivo_salida, elf.datos.data(), elf.datos.size())) {
+        errores() << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+#include "GeneradorFuentes.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+vector<string> formas_memoria() {
+    vector<string> formas = {"[tabla]",     "[tabla+4]",     "[tabla-4]",     "[tabla+ebx]",
+                             "[tabla+esi*4]", "[tabla+ebx+esi*4+8]",
+                             "[0x1000]",    "[-4]",          "[eax+esp]",     "[esp+eax]",
+                             "[ebp+esi]",   "[esi+ebp]"};
+    static const char* const DESPLAZAMIENTOS[] = {"", "+0", "+1", "-1", "+127", "-128", "+128", "-129", "+0x12345678"};
+    static const char* const ESCALAS[] = {"1", "2", "4", "8"};
+    for (const char* b : REGISTROS_FUENTE) {
+        for (const char* d : DESPLAZAMIENTOS) formas.push_back(string("[") + b + d + "]");
+    }
+    for (const char* b : REGISTROS_FUENTE) {
+        for (uint8_t i = 0; i < 8; ++i) {
+            if (i == 4) continue; // ESP no puede ser índice
+            for (const char* e : ESCALAS) {
+                const string sib = string("[") + b + "+" + REGISTROS_FUENTE[i] + "*" + e;
+                formas.push_back(sib + "]");
+                formas.push_back(sib + "+8]");
+                formas.push_back(sib + "+1000]");
+            }
+        }
+    }
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (i == 4) continue;
+        for (const char* e : ESCALAS) {
+            formas.push_back(string("[") + REGISTROS_FUENTE[i] + "*" + e + "]");
+            formas.push_back(string("[") + REGISTROS_FUENTE[i] + "*" + e + "+16]");
+        }
+    }
+    return formas;
+}
+
+void escribir_encabezado_fuente(string& s) {
+    s += "BITS 32\n"
+         "section .data\n"
+         "tabla dd 1, 2, 3, 4, 5, 6, 7, 8\n"
+         "bytes db 0x12, 0x34, 0x56\n"
+         "section .text\n"
+         "inicio:\n";
+}
+
+string generar_fuente(const MezclaFuente& mezcla) {
+    uint32_t estado = mezcla.semilla != 0 ? mezcla.semilla : 1;
+    auto azar = [&](uint32_t n) {
+        estado ^= estado << 13;
+        estado ^= estado >> 17;
+        estado ^= estado << 5;
+        return estado % n;
+    };
+
+    const vector<string> memoria = formas_memoria();
+    const uint32_t num_memoria = static_cast<uint32_t>(memoria.size());
+    const uint32_t cada = mezcla.lineas_por_etiqueta;
+    const uint32_t saltos = cada != 0 ? mezcla.saltos : 0;
+    uint32_t total = mezcla.registros + mezcla.inmediatos + mezcla.memoria + saltos;
+    const uint32_t registros = total != 0 ? mezcla.registros : 1;
+    if (total == 0) total = 1;
+
+    string s;
+    s.reserve(static_cast<size_t>(mezcla.lineas) * 24 + static_cast<size_t>(mezcla.entradas_dd) * 12 + 256);
+    escribir_encabezado_fuente(s);
+
+    uint32_t etiqueta = 0;
+    for (uint32_t i = 0; i < mezcla.lineas; ++i) {
+        if (cada != 0 && i % cada == 0) s.append("e_").append(to_string(etiqueta++)).append(":\n");
+
+        const char* r1 = REGISTROS_FUENTE[azar(8)];
+        const char* r2 = REGISTROS_FUENTE[azar(8)];
+        uint32_t clase = azar(total);
+        s += "    ";
+        if (clase < registros) {
+            s.append(azar(4) == 0 ? "mov" : BINARIAS_FUENTE[azar(6)]).append(" ").append(r1).append(", ").append(r2);
+        } else if ((clase -= registros) < mezcla.inmediatos) {
+            s.append(BINARIAS_FUENTE[azar(6)]).append(" ").append(r1).append(", ").append(INMEDIATOS_FUENTE[azar(12)]);
+        } else if ((clase -= mezcla.inmediatos) < mezcla.memoria) {
+            const string& m = memoria[azar(num_memoria)];
+            switch (azar(3)) {
+            case 0: s.append("mov ").append(r1).append(", ").append(m); break;
+            case 1: s.append("mov ").append(m).append(", ").append(r2); break;
+            default: s.append(BINARIAS_FUENTE[azar(6)]).append(" ").append(r1).append(", ").append(m); break;
+            }
+        } else {
+            // Hasta 3 etiquetas hacia atrás o hacia adelante
+            uint32_t destino;
+            if (azar(2) == 0) destino = etiqueta - 1 - azar(min<uint32_t>(3, etiqueta));
+            else destino = etiqueta + azar(3);
+            s.append(azar(3) == 0 ? "jmp" : CONDICIONALES_FUENTE[azar(16)]).append(" e_").append(to_string(destino));
+        }
+        s += '\n';
+    }
+    // Destinos de los últimos saltos hacia adelante
+    if (cada != 0) {
+        for (uint32_t k = 0; k < 3; ++k) s.append("e_").append(to_string(etiqueta++)).append(":\n");
+    }
+    s += "fin:\n    ret\n";
+
+    if (mezcla.entradas_dd != 0) {
+        s += "section .data\ntabla_grande:\n";
+        for (uint32_t i = 0; i < mezcla.entradas_dd; i += 4) {
+            s += "    dd ";
+            for (uint32_t k = i; k < min(i + 4, mezcla.entradas_dd); ++k) {
+                if (k != i) s += ", ";
+                s += to_string(azar(0x10000000));
+            }
+            s += '\n';
+        }
+    }
+    return s;
+}
@@ -0,0 +1,51 @@
+#ifndef GENERADOR_FUENTES_HPP
+#define GENERADOR_FUENTES_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// --- GENERADOR DE FUENTES SINTÉTICAS ---
+// Fuentes de tamaño y mezcla configurables para el banco de pruebas y el
+// comparador contra NASM. Con la misma MezclaFuente la salida es siempre la
+// misma (xorshift con semilla fija), así las mediciones se pueden comparar
+// entre corridas y entre versiones.
+
+inline constexpr const char* REGISTROS_FUENTE[8] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
+inline constexpr const char* BINARIAS_FUENTE[6] = {"add", "or", "and", "sub", "xor", "cmp"};
+inline constexpr const char* CONDICIONALES_FUENTE[16] = {"jo", "jno", "jb", "jae", "je", "jne", "jbe", "ja",
+                                                         "js", "jns", "jp", "jnp", "jl", "jge", "jle", "jg"};
+
+// Bordes de imm8 con signo y de 32 bits
+inline constexpr const char* INMEDIATOS_FUENTE[12] = {"0",    "1",   "-1",  "127",        "128",        "-128",
+                                                      "-129", "255", "500", "0x7FFFFFFF", "0x80000000", "0xFFFFFFFF"};
+
+struct MezclaFuente {
+    uint32_t lineas = 100000;           // instrucciones en .text
+    uint32_t semilla = 0x9E3779B9u;     // distinta de 0
+
+    // Peso relativo de cada clase de instrucción
+    uint32_t registros = 4;     // op r32, r32 y MOV r32, r32
+    uint32_t inmediatos = 2;    // op r32, imm con los bordes de imm8/imm32
+    uint32_t memoria = 3;       // op/MOV con un operando de formas_memoria()
+    uint32_t saltos = 1;        // JMP/Jcc a etiquetas vecinas, hacia atrás y adelante
+
+    uint32_t lineas_por_etiqueta = 8;   // 0 = sin etiquetas (ni saltos)
+    uint32_t entradas_dd = 0;           // dwords de la tabla grande en .data
+};
+
+// Todos los modos de memoria que arma codificar_memoria: sin registros,
+// base con cada clase de desplazamiento, base+índice*escala, índice sin
+// base, etiqueta con registros, [EBP] y [ESP]. Las etiquetas son de la tabla
+// que escribe escribir_encabezado_fuente.
+vector<string> formas_memoria();
+
+// BITS 32 y una tabla en .data ("tabla") para las referencias con etiqueta;
+// termina en .text con la etiqueta "inicio"
+void escribir_encabezado_fuente(string& s);
+
+string generar_fuente(const MezclaFuente& mezcla);
+
+#endif // GENERADOR_FUENTES_HPP
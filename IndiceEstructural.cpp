@@ -0,0 +1,124 @@
+#include "IndiceEstructural.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define INDICE_X86 1
+#endif
+
+// -----------------------------------------------------------------------------
+// Variante escalar (referencia y resto de cada bloque)
+// -----------------------------------------------------------------------------
+
+static inline bool es_estructural(char c) {
+    return c == '\n' || c == ';' || c == ',' || c == '[' || c == ']';
+}
+
+static size_t indexar_escalar(const char* datos, size_t n, uint32_t* salida, size_t desde) {
+    size_t k = 0;
+    for (size_t i = desde; i < n; ++i) {
+        if (es_estructural(datos[i])) salida[k++] = static_cast<uint32_t>(i);
+    }
+    return k;
+}
+
+static size_t indexar_solo_escalar(const char* datos, size_t n, uint32_t* salida) {
+    return indexar_escalar(datos, n, salida, 0);
+}
+
+#ifdef INDICE_X86
+
+// Vuelca los bits de la máscara como posiciones absolutas
+static inline size_t volcar_mascara(uint32_t mascara, size_t base, uint32_t* salida) {
+    size_t k = 0;
+    while (mascara != 0) {
+        salida[k++] = static_cast<uint32_t>(base + static_cast<size_t>(__builtin_ctz(mascara)));
+        mascara &= mascara - 1;
+    }
+    return k;
+}
+
+// -----------------------------------------------------------------------------
+// SSE2: 16 bytes por iteración
+// -----------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static size_t indexar_sse2(const char* datos, size_t n, uint32_t* salida) {
+    const __m128i salto = _mm_set1_epi8('\n');
+    const __m128i punto_coma = _mm_set1_epi8(';');
+    const __m128i coma = _mm_set1_epi8(',');
+    const __m128i abre = _mm_set1_epi8('[');
+    const __m128i cierra = _mm_set1_epi8(']');
+
+    size_t k = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i));
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, salto), _mm_cmpeq_epi8(v, punto_coma)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, coma),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, abre), _mm_cmpeq_epi8(v, cierra))));
+        uint32_t mascara = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        k += volcar_mascara(mascara, i, salida + k);
+    }
+    k += indexar_escalar(datos, n, salida + k, i);
+    return k;
+}
+
+// -----------------------------------------------------------------------------
+// AVX2: 32 bytes por iteración
+// -----------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static size_t indexar_avx2(const char* datos, size_t n, uint32_t* salida) {
+    const __m256i salto = _mm256_set1_epi8('\n');
+    const __m256i punto_coma = _mm256_set1_epi8(';');
+    const __m256i coma = _mm256_set1_epi8(',');
+    const __m256i abre = _mm256_set1_epi8('[');
+    const __m256i cierra = _mm256_set1_epi8(']');
+
+    size_t k = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(datos + i));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, salto), _mm256_cmpeq_epi8(v, punto_coma)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, coma),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, abre), _mm256_cmpeq_epi8(v, cierra))));
+        uint32_t mascara = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+        k += volcar_mascara(mascara, i, salida + k);
+    }
+    k += indexar_escalar(datos, n, salida + k, i);
+    return k;
+}
+
+#endif // INDICE_X86
+
+// -----------------------------------------------------------------------------
+// Selección en tiempo de ejecución
+// -----------------------------------------------------------------------------
+
+using FuncionIndice = size_t (*)(const char*, size_t, uint32_t*);
+
+struct VarianteIndice {
+    FuncionIndice funcion;
+    const char* nombre;
+};
+
+static VarianteIndice elegir_variante() {
+#ifdef INDICE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {indexar_avx2, "AVX2"};
+    if (__builtin_cpu_supports("sse2")) return {indexar_sse2, "SSE2"};
+#endif
+    return {indexar_solo_escalar, "escalar"};
+}
+
+static const VarianteIndice VARIANTE_INDICE = elegir_variante();
+
+size_t indexar_estructura(const char* datos, size_t n, uint32_t* salida) {
+    return VARIANTE_INDICE.funcion(datos, n, salida);
+}
+
+const char* nivel_simd_indice() {
+    return VARIANTE_INDICE.nombre;
+}
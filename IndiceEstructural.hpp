@@ -0,0 +1,22 @@
+#ifndef INDICE_ESTRUCTURAL_HPP
+#define INDICE_ESTRUCTURAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// --- ÍNDICE ESTRUCTURAL (ETAPA 1) ---
+// Localiza de una pasada todos los caracteres que delimitan la sintaxis
+// ('\n', ';', ',', '[' y ']') en un bloque de la fuente, procesando 16 (SSE2)
+// o 32 (AVX2) bytes por iteración. El analizador de líneas recorre después
+// esta lista de posiciones en lugar de buscar carácter a carácter.
+// La variante SIMD se elige en tiempo de ejecución según la CPU.
+
+// Escribe en 'salida' las posiciones (relativas a 'datos') de los caracteres
+// estructurales, en orden creciente. 'salida' debe tener capacidad para 'n'
+// posiciones. Devuelve cuántas se escribieron.
+size_t indexar_estructura(const char* datos, size_t n, uint32_t* salida);
+
+// Nombre de la variante elegida: "AVX2", "SSE2" o "escalar"
+const char* nivel_simd_indice();
+
+#endif // INDICE_ESTRUCTURAL_HPP
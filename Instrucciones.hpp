@@ -0,0 +1,180 @@
+#ifndef INSTRUCCIONES_HPP
+#define INSTRUCCIONES_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+#include "Lexico.hpp"
+
+using namespace std;
+
+// --- TABLA DE DESCRIPTORES DE INSTRUCCIONES ---
+// Cada mnemónico se describe una sola vez: forma de operandos y opcodes.
+// La búsqueda usa un hash perfecto calculado en tiempo de compilación, por lo
+// que despachar una línea cuesta un hash y una comparación, sin importar
+// cuántas instrucciones se agreguen a la tabla.
+
+enum class FormaInstruccion : uint8_t {
+    Directiva,      // SECTION, GLOBAL, TIMES, ALIGN...: se tratan aparte
+    Binaria,        // ADD, SUB, CMP, XOR, AND, OR (generalizado)
+    Mov,
+    Imul,
+    RegistroCorto,  // opcode+rd: INC (40), DEC (48), POP (58)
+    UnariaF7,       // F7 /ext: MUL, DIV, IDIV
+    Test,
+    Movzx,
+    Xchg,
+    Lea,
+    Push,
+    Call,
+    Loop,
+    Jmp,
+    Jcc,
+    Int,
+    Implicita       // un solo byte de opcode: RET, LEAVE, NOP
+};
+
+struct DescriptorInstruccion {
+    string_view mnemonico;
+    FormaInstruccion forma;
+    uint8_t opcode;          // r/m,reg | opcode base (+rd) | rel8 de Jcc | byte único
+    uint8_t opcode_reg_rm;   // reg,r/m (solo Binaria)
+    uint8_t opcode_eax_imm;  // EAX,imm32 (solo Binaria)
+    uint8_t opcode_imm;      // r/m,imm32 (81) (solo Binaria)
+    uint8_t extension;       // campo /r del ModR/M
+    uint8_t opcode_largo;    // 0F xx de la forma rel32 (solo Jcc)
+};
+
+using FI = FormaInstruccion;
+
+constexpr DescriptorInstruccion TABLA_INSTRUCCIONES[] = {
+    // mnemónico  forma               op    reg_rm eax   imm   /r     largo
+    {"SECTION",   FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"GLOBAL",    FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"EXTERN",    FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"BITS",      FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"INCBIN",    FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"TIMES",     FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"ALIGN",     FI::Directiva,      0x00, 0x00,  0x00, 0x00, 0b000, 0x00},
+
+    {"ADD",       FI::Binaria,        0x01, 0x03,  0x05, 0x81, 0b000, 0x00},
+    {"OR",        FI::Binaria,        0x09, 0x0B,  0x0D, 0x81, 0b001, 0x00},
+    {"AND",       FI::Binaria,        0x21, 0x23,  0x25, 0x81, 0b100, 0x00},
+    {"SUB",       FI::Binaria,        0x29, 0x2B,  0x2D, 0x81, 0b101, 0x00},
+    {"XOR",       FI::Binaria,        0x31, 0x33,  0x35, 0x81, 0b110, 0x00},
+    {"CMP",       FI::Binaria,        0x39, 0x3B,  0x3D, 0x81, 0b111, 0x00},
+
+    {"MOV",       FI::Mov,            0x89, 0x8B,  0x00, 0xC7, 0b000, 0x00},
+    {"IMUL",      FI::Imul,           0x0F, 0xAF,  0x00, 0x00, 0b000, 0x00},
+    {"INC",       FI::RegistroCorto,  0x40, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"DEC",       FI::RegistroCorto,  0x48, 0x00,  0x00, 0x00, 0b001, 0x00},
+    {"POP",       FI::RegistroCorto,  0x58, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"MUL",       FI::UnariaF7,       0xF7, 0x00,  0x00, 0x00, 0b100, 0x00},
+    {"DIV",       FI::UnariaF7,       0xF7, 0x00,  0x00, 0x00, 0b110, 0x00},
+    {"IDIV",      FI::UnariaF7,       0xF7, 0x00,  0x00, 0x00, 0b111, 0x00},
+    {"TEST",      FI::Test,           0x85, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"MOVZX",     FI::Movzx,          0x0F, 0xB6,  0x00, 0x00, 0b000, 0x00},
+    {"XCHG",      FI::Xchg,           0x87, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"LEA",       FI::Lea,            0x8D, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"PUSH",      FI::Push,           0x50, 0x00,  0x00, 0x68, 0b110, 0x00},
+    {"CALL",      FI::Call,           0xE8, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"LOOP",      FI::Loop,           0xE2, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"JMP",       FI::Jmp,            0xEB, 0x00,  0x00, 0x00, 0b000, 0xE9},
+    {"INT",       FI::Int,            0xCD, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"RET",       FI::Implicita,      0xC3, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"LEAVE",     FI::Implicita,      0xC9, 0x00,  0x00, 0x00, 0b000, 0x00},
+    {"NOP",       FI::Implicita,      0x90, 0x00,  0x00, 0x00, 0b000, 0x00},
+
+    // Saltos condicionales: 7x rel8 / 0F 8x rel32
+    {"JO",        FI::Jcc,            0x70, 0x00,  0x00, 0x00, 0b000, 0x80},
+    {"JNO",       FI::Jcc,            0x71, 0x00,  0x00, 0x00, 0b000, 0x81},
+    {"JB",        FI::Jcc,            0x72, 0x00,  0x00, 0x00, 0b000, 0x82},
+    {"JC",        FI::Jcc,            0x72, 0x00,  0x00, 0x00, 0b000, 0x82},
+    {"JNAE",      FI::Jcc,            0x72, 0x00,  0x00, 0x00, 0b000, 0x82},
+    {"JAE",       FI::Jcc,            0x73, 0x00,  0x00, 0x00, 0b000, 0x83},
+    {"JNB",       FI::Jcc,            0x73, 0x00,  0x00, 0x00, 0b000, 0x83},
+    {"JNC",       FI::Jcc,            0x73, 0x00,  0x00, 0x00, 0b000, 0x83},
+    {"JE",        FI::Jcc,            0x74, 0x00,  0x00, 0x00, 0b000, 0x84},
+    {"JZ",        FI::Jcc,            0x74, 0x00,  0x00, 0x00, 0b000, 0x84},
+    {"JNE",       FI::Jcc,            0x75, 0x00,  0x00, 0x00, 0b000, 0x85},
+    {"JNZ",       FI::Jcc,            0x75, 0x00,  0x00, 0x00, 0b000, 0x85},
+    {"JBE",       FI::Jcc,            0x76, 0x00,  0x00, 0x00, 0b000, 0x86},
+    {"JNA",       FI::Jcc,            0x76, 0x00,  0x00, 0x00, 0b000, 0x86},
+    {"JA",        FI::Jcc,            0x77, 0x00,  0x00, 0x00, 0b000, 0x87},
+    {"JNBE",      FI::Jcc,            0x77, 0x00,  0x00, 0x00, 0b000, 0x87},
+    {"JS",        FI::Jcc,            0x78, 0x00,  0x00, 0x00, 0b000, 0x88},
+    {"JNS",       FI::Jcc,            0x79, 0x00,  0x00, 0x00, 0b000, 0x89},
+    {"JP",        FI::Jcc,            0x7A, 0x00,  0x00, 0x00, 0b000, 0x8A},
+    {"JNP",       FI::Jcc,            0x7B, 0x00,  0x00, 0x00, 0b000, 0x8B},
+    {"JL",        FI::Jcc,            0x7C, 0x00,  0x00, 0x00, 0b000, 0x8C},
+    {"JNGE",      FI::Jcc,            0x7C, 0x00,  0x00, 0x00, 0b000, 0x8C},
+    {"JGE",       FI::Jcc,            0x7D, 0x00,  0x00, 0x00, 0b000, 0x8D},
+    {"JNL",       FI::Jcc,            0x7D, 0x00,  0x00, 0x00, 0b000, 0x8D},
+    {"JLE",       FI::Jcc,            0x7E, 0x00,  0x00, 0x00, 0b000, 0x8E},
+    {"JNG",       FI::Jcc,            0x7E, 0x00,  0x00, 0x00, 0b000, 0x8E},
+    {"JG",        FI::Jcc,            0x7F, 0x00,  0x00, 0x00, 0b000, 0x8F},
+    {"JNLE",      FI::Jcc,            0x7F, 0x00,  0x00, 0x00, 0b000, 0x8F},
+};
+
+constexpr size_t NUM_INSTRUCCIONES = sizeof(TABLA_INSTRUCCIONES) / sizeof(TABLA_INSTRUCCIONES[0]);
+
+// --- HASH PERFECTO EN TIEMPO DE COMPILACIÓN ---
+// Tamaño potencia de 2 para reducir el índice con una máscara.
+constexpr size_t TAMANO_HASH_INSTR = 256;
+static_assert(NUM_INSTRUCCIONES < TAMANO_HASH_INSTR, "Tabla de hash de instrucciones llena");
+
+// FNV-1a sobre los caracteres pasados a mayúsculas, con semilla variable
+constexpr uint32_t hash_mnemonico(string_view s, uint32_t semilla) {
+    uint32_t h = 2166136261u ^ semilla;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(a_mayuscula(c));
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+constexpr bool semilla_sin_colisiones(uint32_t semilla) {
+    bool ocupado[TAMANO_HASH_INSTR] = {};
+    for (size_t i = 0; i < NUM_INSTRUCCIONES; ++i) {
+        size_t h = hash_mnemonico(TABLA_INSTRUCCIONES[i].mnemonico, semilla) & (TAMANO_HASH_INSTR - 1);
+        if (ocupado[h]) return false;
+        ocupado[h] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t buscar_semilla() {
+    uint32_t semilla = 0;
+    while (!semilla_sin_colisiones(semilla)) ++semilla;
+    return semilla;
+}
+
+constexpr uint32_t SEMILLA_HASH_INSTR = buscar_semilla();
+
+// Cada casilla guarda índice + 1 del descriptor (0 = vacía)
+struct IndiceHashInstr {
+    uint8_t casilla[TAMANO_HASH_INSTR] = {};
+};
+
+constexpr IndiceHashInstr construir_indice_instr() {
+    IndiceHashInstr indice;
+    for (size_t i = 0; i < NUM_INSTRUCCIONES; ++i) {
+        size_t h = hash_mnemonico(TABLA_INSTRUCCIONES[i].mnemonico, SEMILLA_HASH_INSTR) & (TAMANO_HASH_INSTR - 1);
+        indice.casilla[h] = static_cast<uint8_t>(i + 1);
+    }
+    return indice;
+}
+
+constexpr IndiceHashInstr INDICE_HASH_INSTR = construir_indice_instr();
+
+// Devuelve el descriptor del mnemónico o nullptr si no existe
+inline const DescriptorInstruccion* buscar_instruccion(string_view mnem) {
+    size_t h = hash_mnemonico(mnem, SEMILLA_HASH_INSTR) & (TAMANO_HASH_INSTR - 1);
+    uint8_t i = INDICE_HASH_INSTR.casilla[h];
+    if (i == 0) return nullptr;
+    const DescriptorInstruccion& d = TABLA_INSTRUCCIONES[i - 1];
+    return iguales_ci(mnem, d.mnemonico) ? &d : nullptr;
+}
+
+#endif // INSTRUCCIONES_HPP
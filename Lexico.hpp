@@ -0,0 +1,126 @@
+#ifndef LEXICO_HPP
+#define LEXICO_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+using namespace std;
+
+// --- ANALIZADOR LÉXICO SOBRE VISTAS ---
+// Todas las funciones trabajan con string_view apuntando al buffer fuente:
+// no se copian líneas ni se generan versiones en mayúsculas. Las comparaciones
+// de mnemónicos, registros y etiquetas son insensibles a mayúsculas.
+
+inline bool es_espacio(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+constexpr char a_mayuscula(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+}
+
+// Compara sin distinguir mayúsculas. 'patron' debe venir ya en mayúsculas.
+inline bool iguales_ci(string_view s, string_view patron) {
+    if (s.size() != patron.size()) return false;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (a_mayuscula(s[i]) != patron[i]) return false;
+    }
+    return true;
+}
+
+// Busca 'patron' (en mayúsculas) dentro de 's' sin distinguir mayúsculas.
+inline size_t buscar_ci(string_view s, string_view patron, size_t desde = 0) {
+    if (patron.size() > s.size()) return string_view::npos;
+    for (size_t i = desde; i + patron.size() <= s.size(); ++i) {
+        if (iguales_ci(s.substr(i, patron.size()), patron)) return i;
+    }
+    return string_view::npos;
+}
+
+inline string_view recortar(string_view s) {
+    size_t ini = 0, fin = s.size();
+    while (ini < fin && es_espacio(s[ini])) ++ini;
+    while (fin > ini && es_espacio(s[fin - 1])) --fin;
+    return s.substr(ini, fin - ini);
+}
+
+// Equivalente a limpiar_linea, sin copias: quita el comentario y recorta.
+inline string_view limpiar_vista(string_view s) {
+    size_t pos = s.find(';');
+    if (pos != string_view::npos) s = s.substr(0, pos);
+    return recortar(s);
+}
+
+// Extrae el primer token delimitado por espacios y deja en 'resto' lo que sigue.
+inline string_view primer_token(string_view s, string_view& resto) {
+    size_t i = 0;
+    while (i < s.size() && es_espacio(s[i])) ++i;
+    size_t ini = i;
+    while (i < s.size() && !es_espacio(s[i])) ++i;
+    resto = s.substr(i);
+    return s.substr(ini, i - ini);
+}
+
+// Resultado de lexar una línea: todo son vistas sobre la línea original.
+struct LineaLexada {
+    string_view etiqueta;    // "ETIQUETA" si la línea es "ETIQUETA:"
+    string_view mnemonico;   // primer token (mnemónico, directiva o nombre de dato)
+    string_view resto;       // operandos sin el mnemónico, ya recortados
+    string_view directiva;   // primer token de 'resto' (DD, DB, EQU...)
+    string_view valores;     // lo que sigue a 'directiva', recortado
+    string_view dest;        // operando antes de la primera coma
+    string_view src;         // operando después de la primera coma
+    bool dos_operandos = false;
+};
+
+// Lexa una línea ya sin comentario. 'coma' apunta a la primera coma fuera de
+// corchetes (nullptr si no hay); viene del índice estructural o de lexar_linea.
+inline bool lexar_linea_indexada(string_view linea, const char* coma, LineaLexada& l) {
+    linea = recortar(linea);
+    if (linea.empty()) return false;
+
+    l = LineaLexada();
+    if (linea.back() == ':') {
+        l.etiqueta = linea.substr(0, linea.size() - 1);
+        return true;
+    }
+
+    string_view resto;
+    l.mnemonico = primer_token(linea, resto);
+    l.resto = recortar(resto);
+
+    string_view valores;
+    l.directiva = primer_token(l.resto, valores);
+    l.valores = recortar(valores);
+
+    const char* ini_resto = l.resto.data();
+    if (coma != nullptr && coma >= ini_resto && coma < ini_resto + l.resto.size()) {
+        size_t c = static_cast<size_t>(coma - ini_resto);
+        l.dest = recortar(l.resto.substr(0, c));
+        l.src = recortar(l.resto.substr(c + 1));
+        l.dos_operandos = !l.dest.empty() && !l.src.empty();
+    } else {
+        l.dest = l.resto;
+    }
+    return true;
+}
+
+// Versión escalar: busca el comentario y la coma carácter a carácter
+inline bool lexar_linea(string_view linea, LineaLexada& l) {
+    linea = limpiar_vista(linea);
+
+    const char* coma = nullptr;
+    int profundidad = 0;
+    for (const char& c : linea) {
+        if (c == '[') ++profundidad;
+        else if (c == ']' && profundidad > 0) --profundidad;
+        else if (c == ',' && profundidad == 0) {
+            coma = &c;
+            break;
+        }
+    }
+    return lexar_linea_indexada(linea, coma, l);
+}
+
+#endif // LEXICO_HPP
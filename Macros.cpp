@@ -0,0 +1,250 @@
+#include "EnsambladorIA32.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+// --- PREPROCESADOR: %macro Y %rep ---
+// Las directivas del preprocesador empiezan con '%' al comienzo de la línea.
+// Un bloque abierto junta sus líneas (vistas sobre la fuente) hasta el cierre
+// correspondiente; los bloques internos viajan como texto del externo.
+//
+// Lo que se repite se codifica una sola vez: el cuerpo de un %rep se ensambla
+// en la primera vuelta y las demás copian sus bytes, referencias y saltos con
+// replicar_tramo. Lo mismo con una macro invocada otra vez con los mismos
+// argumentos en la misma sección. Si el cuerpo define etiquetas o cambia de
+// sección, cada vuelta se ensambla de nuevo.
+
+static const uint32_t MAX_PROFUNDIDAD_MACROS = 64;
+
+// ¿Hay alguna línea que empiece con '%'? Se busca con memchr: las fuentes
+// sin preprocesador casi nunca contienen el carácter.
+bool EnsambladorIA32::usa_preprocesador(string_view fuente) {
+    const char* inicio = fuente.data();
+    const char* fin = inicio + fuente.size();
+    const char* p = inicio;
+    while ((p = static_cast<const char*>(memchr(p, '%', static_cast<size_t>(fin - p)))) != nullptr) {
+        const char* q = p;
+        while (q > inicio && (q[-1] == ' ' || q[-1] == '\t')) --q;
+        if (q == inicio || q[-1] == '\n' || q[-1] == '\r') return true;
+        ++p;
+    }
+    return false;
+}
+
+// Letras, dígitos, '_', '.' y '@', sin empezar con dígito
+static bool es_nombre_macro(string_view nombre) {
+    if (nombre.empty() || (nombre[0] >= '0' && nombre[0] <= '9')) return false;
+    for (char c : nombre) {
+        const char m = a_mayuscula(c);
+        if (!((m >= 'A' && m <= 'Z') || (m >= '0' && m <= '9') || m == '_' || m == '.' || m == '@')) return false;
+    }
+    return true;
+}
+
+// Separa los argumentos de una invocación por las comas fuera de corchetes
+static void separar_argumentos(string_view texto, vector<string_view>& argumentos) {
+    argumentos.clear();
+    texto = recortar(texto);
+    if (texto.empty()) return;
+    int profundidad = 0;
+    size_t ini = 0;
+    for (size_t i = 0; i < texto.size(); ++i) {
+        const char c = texto[i];
+        if (c == '[') ++profundidad;
+        else if (c == ']' && profundidad > 0) --profundidad;
+        else if (c == ',' && profundidad == 0) {
+            argumentos.push_back(recortar(texto.substr(ini, i - ini)));
+            ini = i + 1;
+        }
+    }
+    argumentos.push_back(recortar(texto.substr(ini)));
+}
+
+// Si la línea pertenece al preprocesador (directiva o línea de un bloque
+// abierto) la consume y devuelve true.
+bool EnsambladorIA32::preprocesar_linea(string_view linea) {
+    if (bloques_abiertos.empty()) {
+        size_t i = 0;
+        while (i < linea.size() && es_espacio(linea[i])) ++i;
+        if (i == linea.size() || linea[i] != '%') return false;
+        procesar_directiva_pre(limpiar_vista(linea));
+        return true;
+    }
+
+    BloqueAbierto& bloque = bloques_abiertos.back();
+    string_view resto;
+    const string_view directiva = primer_token(limpiar_vista(linea), resto);
+    if (iguales_ci(directiva, "%MACRO") || iguales_ci(directiva, "%REP")) {
+        ++bloque.anidados;
+    } else if (iguales_ci(directiva, "%ENDMACRO") || iguales_ci(directiva, "%ENDREP")) {
+        if (bloque.anidados > 0) {
+            --bloque.anidados;
+        } else {
+            const bool cierra_macro = iguales_ci(directiva, "%ENDMACRO");
+            if (cierra_macro != bloque.es_macro) {
+                errores() << "Error: " << directiva << " cierra un "
+                          << (bloque.es_macro ? "%macro" : "%rep") << endl;
+            }
+            BloqueAbierto cerrado = move(bloque);
+            bloques_abiertos.pop_back();
+            ejecutar_bloque(cerrado);
+            return true;
+        }
+    }
+    bloque.lineas.push_back(linea);
+    return true;
+}
+
+// 'linea' ya viene sin comentario y recortada
+void EnsambladorIA32::procesar_directiva_pre(string_view linea) {
+    string_view argumentos;
+    const string_view directiva = primer_token(linea, argumentos);
+    argumentos = recortar(argumentos);
+
+    if (iguales_ci(directiva, "%MACRO")) {
+        string_view cuenta;
+        const string_view nombre = primer_token(argumentos, cuenta);
+        cuenta = recortar(cuenta);
+        uint32_t num = 0;
+        if (!es_nombre_macro(nombre)) {
+            errores() << "Error en %macro: nombre invalido '" << nombre << "'" << endl;
+        } else if (!cuenta.empty() && !obtener_inmediato32(cuenta, num)) {
+            errores() << "Error en %macro: cantidad de parametros invalida '" << cuenta << "'" << endl;
+        }
+        BloqueAbierto bloque;
+        bloque.es_macro = true;
+        bloque.macro = es_nombre_macro(nombre) ? nombres_macros.internar(nombre) : SIN_SIMBOLO;
+        bloque.cantidad = num;
+        bloques_abiertos.push_back(move(bloque));
+        return;
+    }
+    if (iguales_ci(directiva, "%REP")) {
+        uint32_t n = 0;
+        if (!obtener_inmediato32(argumentos, n)) {
+            errores() << "Error en %rep: cantidad invalida '" << argumentos << "'" << endl;
+        }
+        BloqueAbierto bloque;
+        bloque.cantidad = n;
+        bloques_abiertos.push_back(move(bloque));
+        return;
+    }
+    if (iguales_ci(directiva, "%ENDMACRO") || iguales_ci(directiva, "%ENDREP")) {
+        errores() << "Error: " << directiva << " sin bloque abierto" << endl;
+        return;
+    }
+    errores() << "Error: Directiva de preprocesador no soportada: " << directiva << endl;
+}
+
+void EnsambladorIA32::ejecutar_bloque(const BloqueAbierto& bloque) {
+    if (bloque.es_macro) {
+        if (bloque.macro == SIN_SIMBOLO) return;
+        if (macros.size() <= bloque.macro) macros.resize(bloque.macro + 1);
+        DefinicionMacro& m = macros[bloque.macro];
+        m.num_parametros = bloque.cantidad;
+        m.cuerpo.clear();
+        for (string_view l : bloque.lineas) {
+            m.cuerpo.append(limpiar_vista(l));
+            m.cuerpo.push_back('\n');
+        }
+        // Las expansiones recordadas pueden ser de la definición anterior
+        invocaciones.clear();
+        return;
+    }
+
+    if (bloque.cantidad == 0) return;
+    TramoEmitido tramo = iniciar_tramo();
+    for (string_view l : bloque.lineas) procesar_linea(l);
+    if (cerrar_tramo(tramo, false)) {
+        replicar_tramo(tramo, bloque.cantidad - 1);
+        return;
+    }
+    for (uint32_t k = 1; k < bloque.cantidad; ++k) {
+        for (string_view l : bloque.lineas) procesar_linea(l);
+    }
+}
+
+// Si 'linea' invoca una macro la expande y devuelve true
+bool EnsambladorIA32::expandir_macro(const LineaLexada& linea) {
+    const uint32_t id = nombres_macros.buscar(linea.mnemonico);
+    if (id == SIN_SIMBOLO || id >= macros.size()) return false;
+
+    vector<string_view> argumentos;
+    separar_argumentos(linea.resto, argumentos);
+    const uint32_t num_parametros = macros[id].num_parametros;
+    if (argumentos.size() != num_parametros) {
+        errores() << "Error: la macro " << linea.mnemonico << " espera " << num_parametros
+                  << " parametros y recibio " << argumentos.size() << endl;
+        return true;
+    }
+    if (profundidad_macros >= MAX_PROFUNDIDAD_MACROS) {
+        errores() << "Error: demasiadas macros anidadas al expandir " << linea.mnemonico << endl;
+        return true;
+    }
+
+    // Invocación ya vista con los mismos argumentos: se copia lo emitido
+    string clave = to_string(id);
+    for (string_view a : argumentos) {
+        clave.push_back('\0');
+        clave.append(a);
+    }
+    auto memo = invocaciones.find(clave);
+    if (memo != invocaciones.end() && memo->second.seccion == seccion_actual) {
+        replicar_tramo(memo->second, 1);
+        return true;
+    }
+
+    // Sustitución de %1..%n, %0 y %%nombre (etiqueta propia de la invocación)
+    const string& cuerpo = macros[id].cuerpo;
+    const uint32_t expansion = ++num_expansiones;
+    string texto;
+    texto.reserve(cuerpo.size());
+    for (size_t i = 0; i < cuerpo.size(); ++i) {
+        const char c = cuerpo[i];
+        if (c != '%' || i + 1 == cuerpo.size()) {
+            texto.push_back(c);
+        } else if (cuerpo[i + 1] == '%') {
+            texto.append("..@").append(to_string(expansion)).push_back('.');
+            ++i;
+        } else if (cuerpo[i + 1] >= '0' && cuerpo[i + 1] <= '9') {
+            uint32_t n = 0;
+            while (i + 1 < cuerpo.size() && cuerpo[i + 1] >= '0' && cuerpo[i + 1] <= '9') {
+                n = n * 10 + static_cast<uint32_t>(cuerpo[++i] - '0');
+            }
+            if (n == 0) texto.append(to_string(num_parametros));
+            else if (n <= num_parametros) texto.append(argumentos[n - 1]);
+            else errores() << "Error: la macro " << linea.mnemonico << " no tiene parametro %" << n << endl;
+        } else {
+            texto.push_back(c);
+        }
+    }
+
+    // Los bloques abiertos dentro de la expansión apuntan a 'texto': deben
+    // cerrarse antes de que termine
+    const size_t abiertos = bloques_abiertos.size();
+    TramoEmitido tramo = iniciar_tramo();
+    ++profundidad_macros;
+    size_t ini = 0;
+    while (ini < texto.size()) {
+        size_t fin = texto.find('\n', ini);
+        if (fin == string::npos) fin = texto.size();
+        procesar_linea(string_view(texto).substr(ini, fin - ini));
+        ini = fin + 1;
+    }
+    --profundidad_macros;
+    if (bloques_abiertos.size() > abiertos) {
+        errores() << "Error: bloque sin cerrar dentro de la macro " << linea.mnemonico << endl;
+        bloques_abiertos.resize(abiertos);
+    }
+
+    if (cerrar_tramo(tramo, false)) invocaciones[move(clave)] = tramo;
+    return true;
+}
+
+// Fin de la fuente: los bloques que siguen abiertos se descartan
+void EnsambladorIA32::cerrar_preprocesador() {
+    for (const BloqueAbierto& b : bloques_abiertos) {
+        errores() << "Error: falta " << (b.es_macro ? "%endmacro" : "%endrep") << endl;
+    }
+    bloques_abiertos.clear();
+}
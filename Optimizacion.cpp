@@ -0,0 +1,282 @@
+#include "EnsambladorIA32.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+// --- OPTIMIZACIÓN DE MIRILLA (-O1) ---
+// Trabaja sobre cada instrucción ya decodificada, antes de codificarla:
+//
+//   MOV r32, 0                 -> XOR r32, r32             (5 -> 2 bytes)
+//   ADD/SUB r32, 1             -> INC/DEC r32              (3-6 -> 1 byte)
+//   CMP r32, 0                 -> TEST r32, r32            (3-5 -> 2 bytes)
+//   IMUL r32, 2^k              -> SHL r32, k               (latencia 3 -> 1)
+//   IMUL r32, 3/5/9            -> LEA r32, [r32 + r32*k]   (latencia 3 -> 1)
+//   MOV r, s + ADD r, x        -> LEA r, [s + x]
+//
+// CMP r32, 0 y TEST r32, r32 dejan las mismas banderas (salvo AF, que
+// ninguna instrucción soportada lee), así que se reescribe siempre. Las
+// demás cambian banderas: se emite la forma original y la reescritura queda
+// pendiente hasta ver una instrucción que escriba esas banderas sin leerlas.
+// Un salto, una etiqueta, datos, directivas o el fin de la fuente la
+// descartan, igual que una instrucción intermedia con referencias (sus
+// posiciones ya quedaron registradas).
+
+// Banderas que escribe la instrucción sin leerlas antes; LEE_BANDERAS si
+// puede leerlas o cambia el flujo (lo que sigue no es la instrucción de al
+// lado)
+static const uint8_t LEE_BANDERAS = 0x80;
+
+static const uint8_t REG_ESP = 0b100;
+
+static uint8_t efecto_banderas(const Instruccion& ins) {
+    switch (ins.desc->forma) {
+        case FormaInstruccion::Binaria:
+        case FormaInstruccion::Test:
+        case FormaInstruccion::Imul:
+        case FormaInstruccion::UnariaF7:
+            // MUL/IMUL/DIV dejan algunas indefinidas: tampoco se pueden leer
+            return BANDERAS_TODAS;
+        case FormaInstruccion::RegistroCorto:
+            // INC/DEC conservan CF; POP no toca banderas
+            return ins.desc->opcode == 0x58 ? 0 : BANDERAS_RESTO;
+        case FormaInstruccion::Mov:
+        case FormaInstruccion::Movzx:
+        case FormaInstruccion::Xchg:
+        case FormaInstruccion::Lea:
+        case FormaInstruccion::Push:
+            return 0;
+        case FormaInstruccion::Implicita:
+            return ins.desc->opcode == 0xC3 ? LEE_BANDERAS : 0;   // RET
+        default:
+            return LEE_BANDERAS;
+    }
+}
+
+static bool es_registro32(const Operando& op) {
+    return op.tipo == TipoOperando::Registro && op.tamano == 4;
+}
+
+static const char* const NOMBRES_REGLAS[NUM_REGLAS_OPTIMIZACION] = {
+    "MOV r32, 0 -> XOR r32, r32",
+    "ADD/SUB r32, 1 -> INC/DEC r32",
+    "CMP r32, 0 -> TEST r32, r32",
+    "IMUL r32, 2^k -> SHL r32, k",
+    "IMUL r32, 3/5/9 -> LEA",
+    "MOV r, s + ADD r, x -> LEA r, [s + x]",
+};
+
+// Codifica 'ins' y guarda sus bytes en r.nuevo sin dejarlos en el código.
+// Solo se usa con formas sin referencias.
+void EnsambladorIA32::codificar_aparte(const Instruccion& ins, ReescrituraPendiente& r) {
+    vector<uint8_t>& codigo = *codigo_actual;
+    const uint32_t inicio = static_cast<uint32_t>(contador_posicion);
+    emitir_instruccion(ins);
+    r.largo_nuevo = static_cast<uint8_t>(static_cast<uint32_t>(contador_posicion) - inicio);
+    memcpy(r.nuevo, codigo.data() + inicio, r.largo_nuevo);
+    codigo.resize(inicio);
+    contador_posicion = static_cast<int>(inicio);
+}
+
+void EnsambladorIA32::agregar_reescritura(const ReescrituraPendiente& r) {
+    if (r.largo_nuevo > r.largo) return;
+    if (reescrituras.empty()) {
+        refs_ventana = referencias_pendientes.size();
+        saltos_ventana = saltos_relajables.size();
+    }
+    reescrituras.push_back(r);
+}
+
+// Las reescrituras cuyas banderas ya murieron se aplican: se copian sus
+// bytes nuevos y se corre hacia atrás todo lo emitido después.
+void EnsambladorIA32::aplicar_reescrituras(uint8_t banderas_escritas) {
+    vector<uint8_t>& codigo = *codigo_actual;
+    size_t quedan = 0;
+    for (size_t i = 0; i < reescrituras.size(); ++i) {
+        ReescrituraPendiente r = reescrituras[i];
+        r.banderas &= static_cast<uint8_t>(~banderas_escritas);
+        if (r.banderas != 0) {
+            reescrituras[quedan++] = r;
+            continue;
+        }
+        const uint32_t fin_original = r.posicion + r.largo;
+        const uint32_t ahorro = r.largo - r.largo_nuevo;
+        memcpy(codigo.data() + r.posicion, r.nuevo, r.largo_nuevo);
+        memmove(codigo.data() + r.posicion + r.largo_nuevo, codigo.data() + fin_original,
+                static_cast<size_t>(contador_posicion) - fin_original);
+        codigo.resize(codigo.size() - ahorro);
+        contador_posicion -= static_cast<int>(ahorro);
+        for (size_t j = i + 1; j < reescrituras.size(); ++j) reescrituras[j].posicion -= ahorro;
+        if (posicion_mov_previo != SIN_SIMBOLO && posicion_mov_previo > r.posicion) posicion_mov_previo -= ahorro;
+
+        const size_t regla = static_cast<size_t>(r.regla);
+        ++estadisticas_opt.aplicadas[regla];
+        estadisticas_opt.bytes_ahorrados[regla] += ahorro;
+    }
+    reescrituras.resize(quedan);
+}
+
+// Barrera: lo que sigue puede leer cualquier bandera
+void EnsambladorIA32::cortar_optimizacion() {
+    estadisticas_opt.descartadas += static_cast<uint32_t>(reescrituras.size());
+    reescrituras.clear();
+    posicion_mov_previo = SIN_SIMBOLO;
+}
+
+void EnsambladorIA32::optimizar_instruccion(const Instruccion& ins) {
+    static const DescriptorInstruccion* const XOR = buscar_instruccion("XOR");
+    static const DescriptorInstruccion* const TEST = buscar_instruccion("TEST");
+    static const DescriptorInstruccion* const INC = buscar_instruccion("INC");
+    static const DescriptorInstruccion* const DEC = buscar_instruccion("DEC");
+    static const DescriptorInstruccion* const LEA = buscar_instruccion("LEA");
+
+    // 1. Lo pendiente: se descarta si entre medio quedaron referencias o
+    //    saltos registrados, o si esta instrucción puede leer las banderas
+    if (!reescrituras.empty()) {
+        const uint8_t efecto = efecto_banderas(ins);
+        if (efecto & LEE_BANDERAS || referencias_pendientes.size() != refs_ventana ||
+            saltos_relajables.size() != saltos_ventana) {
+            estadisticas_opt.descartadas += static_cast<uint32_t>(reescrituras.size());
+            reescrituras.clear();
+        } else if (efecto != 0) {
+            aplicar_reescrituras(efecto);
+        }
+    }
+
+    const FormaInstruccion forma = ins.desc->forma;
+    const string_view mnem = ins.desc->mnemonico;
+    const bool dest_reg = ins.num_operandos == 2 && es_registro32(ins.dest);
+    const bool src_imm = dest_reg && ins.src.tipo == TipoOperando::Inmediato;
+    const bool src_reg = dest_reg && es_registro32(ins.src);
+    const uint32_t inicio = static_cast<uint32_t>(contador_posicion);
+
+    // 2. MOV r, s seguido de ADD/SUB r, x: un LEA que no toca banderas
+    const bool hay_mov_previo = posicion_mov_previo != SIN_SIMBOLO && inicio == posicion_mov_previo + 2;
+    if (hay_mov_previo && forma == FormaInstruccion::Binaria && dest_reg && ins.dest.reg == mov_previo_dest &&
+        (iguales_ci(mnem, "ADD") ? (src_imm || src_reg) : (iguales_ci(mnem, "SUB") && src_imm))) {
+        ReescrituraPendiente r;
+        r.posicion = posicion_mov_previo;
+        r.banderas = BANDERAS_TODAS;
+        r.regla = ReglaOptimizacion::MovSumaLea;
+        Instruccion lea;
+        lea.desc = LEA;
+        lea.num_operandos = 2;
+        lea.dest = ins.dest;
+        lea.src.tipo = TipoOperando::Memoria;
+        lea.src.base = static_cast<int8_t>(mov_previo_src);
+        if (src_reg) {
+            // ESP no puede ser índice: si lo es, pasa a base
+            const uint8_t otro = ins.src.reg == mov_previo_dest ? mov_previo_src : ins.src.reg;
+            lea.src.indice = static_cast<int8_t>(otro);
+            if (otro == REG_ESP) swap(lea.src.base, lea.src.indice);
+        } else {
+            lea.src.disp = static_cast<int32_t>(iguales_ci(mnem, "SUB") ? 0u - ins.src.inmediato : ins.src.inmediato);
+        }
+        if (lea.src.indice != REG_ESP) {
+            codificar_aparte(lea, r);
+            emitir_instruccion(ins);
+            r.largo = static_cast<uint8_t>(static_cast<uint32_t>(contador_posicion) - r.posicion);
+            posicion_mov_previo = SIN_SIMBOLO;
+            agregar_reescritura(r);
+            return;
+        }
+    }
+    posicion_mov_previo = SIN_SIMBOLO;
+
+    ReescrituraPendiente r;
+    r.posicion = inicio;
+    Instruccion nueva;
+    nueva.dest = ins.dest;
+    bool candidata = false;
+
+    if (forma == FormaInstruccion::Binaria && src_imm && iguales_ci(mnem, "CMP") && ins.src.inmediato == 0) {
+        // 3. CMP r, 0: mismas banderas que TEST r, r; se reescribe ya
+        nueva.desc = TEST;
+        nueva.num_operandos = 2;
+        nueva.src = ins.dest;
+        emitir_instruccion(ins);
+        r.largo = static_cast<uint8_t>(static_cast<uint32_t>(contador_posicion) - inicio);
+        codigo_actual->resize(inicio);
+        contador_posicion = static_cast<int>(inicio);
+        emitir_instruccion(nueva);
+        const size_t regla = static_cast<size_t>(ReglaOptimizacion::CmpCeroTest);
+        ++estadisticas_opt.aplicadas[regla];
+        estadisticas_opt.bytes_ahorrados[regla] += r.largo - (static_cast<uint32_t>(contador_posicion) - inicio);
+        return;
+    } else if (forma == FormaInstruccion::Mov && src_imm && ins.src.inmediato == 0) {
+        // 4. MOV r, 0 -> XOR r, r
+        nueva.desc = XOR;
+        nueva.num_operandos = 2;
+        nueva.src = ins.dest;
+        r.banderas = BANDERAS_TODAS;
+        r.regla = ReglaOptimizacion::MovCeroXor;
+        candidata = true;
+    } else if (forma == FormaInstruccion::Binaria && src_imm && (iguales_ci(mnem, "ADD") || iguales_ci(mnem, "SUB")) &&
+               (ins.src.inmediato == 1 || ins.src.inmediato == 0xFFFFFFFFu)) {
+        // 5. ADD/SUB r, ±1 -> INC/DEC r: solo cambia CF, que INC/DEC conservan
+        const bool suma = iguales_ci(mnem, "ADD") == (ins.src.inmediato == 1);
+        nueva.desc = suma ? INC : DEC;
+        nueva.num_operandos = 1;
+        r.banderas = BANDERA_CF;
+        r.regla = ReglaOptimizacion::SumaUnoInc;
+        candidata = true;
+    } else if (forma == FormaInstruccion::Imul && src_imm) {
+        const uint32_t v = ins.src.inmediato;
+        if (v >= 2 && (v & (v - 1)) == 0) {
+            // 6. IMUL r, 2^k -> SHL r, k (D1 /4 o C1 /4 ib; SHL no está en la tabla)
+            uint8_t k = 0;
+            while ((1u << k) != v) ++k;
+            r.nuevo[0] = k == 1 ? 0xD1 : 0xC1;
+            r.nuevo[1] = generar_modrm(0b11, 0b100, ins.dest.reg);
+            r.nuevo[2] = k;
+            r.largo_nuevo = k == 1 ? 2 : 3;
+            r.banderas = BANDERAS_TODAS;
+            r.regla = ReglaOptimizacion::ImulDesplazamiento;
+            emitir_instruccion(ins);
+            r.largo = static_cast<uint8_t>(static_cast<uint32_t>(contador_posicion) - inicio);
+            agregar_reescritura(r);
+            return;
+        }
+        if ((v == 3 || v == 5 || v == 9) && ins.dest.reg != REG_ESP) {
+            // 7. IMUL r, 3/5/9 -> LEA r, [r + r*2/4/8]
+            nueva.desc = LEA;
+            nueva.num_operandos = 2;
+            nueva.src.tipo = TipoOperando::Memoria;
+            nueva.src.base = static_cast<int8_t>(ins.dest.reg);
+            nueva.src.indice = static_cast<int8_t>(ins.dest.reg);
+            nueva.src.escala = static_cast<uint8_t>(v - 1);
+            r.banderas = BANDERAS_TODAS;
+            r.regla = ReglaOptimizacion::ImulLea;
+            candidata = true;
+        }
+    }
+
+    if (candidata) {
+        codificar_aparte(nueva, r);
+        emitir_instruccion(ins);
+        r.largo = static_cast<uint8_t>(static_cast<uint32_t>(contador_posicion) - inicio);
+        agregar_reescritura(r);
+        return;
+    }
+
+    emitir_instruccion(ins);
+    if (forma == FormaInstruccion::Mov && src_reg && ins.dest.reg != ins.src.reg &&
+        static_cast<uint32_t>(contador_posicion) == inicio + 2) {
+        posicion_mov_previo = inicio;
+        mov_previo_dest = ins.dest.reg;
+        mov_previo_src = ins.src.reg;
+    }
+}
+
+void EnsambladorIA32::informe_optimizacion(ostream& salida) const {
+    uint32_t total = 0, bytes = 0;
+    for (size_t i = 0; i < NUM_REGLAS_OPTIMIZACION; ++i) {
+        if (estadisticas_opt.aplicadas[i] == 0) continue;
+        salida << "Optimizacion: " << NOMBRES_REGLAS[i] << ": " << estadisticas_opt.aplicadas[i] << " ("
+               << estadisticas_opt.bytes_ahorrados[i] << " bytes menos)" << endl;
+        total += estadisticas_opt.aplicadas[i];
+        bytes += estadisticas_opt.bytes_ahorrados[i];
+    }
+    salida << "Optimizacion: " << total << " reescrituras, " << bytes << " bytes menos; "
+           << estadisticas_opt.descartadas << " descartadas por banderas posiblemente vivas" << endl;
+}
@@ -0,0 +1,79 @@
+#include "PoolTrabajo.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+PoolTrabajo::PoolTrabajo(unsigned hilos) : num_hilos(hilos) {
+    if (num_hilos == 0) num_hilos = max(1u, thread::hardware_concurrency());
+}
+
+namespace {
+
+// Cola de un trabajador; el dueño saca por atrás y los ladrones por delante
+struct ColaTareas {
+    mutex cerrojo;
+    deque<size_t> tareas;
+
+    bool sacar(size_t& tarea) {
+        lock_guard<mutex> g(cerrojo);
+        if (tareas.empty()) return false;
+        tarea = tareas.back();
+        tareas.pop_back();
+        return true;
+    }
+
+    bool robar(size_t& tarea) {
+        lock_guard<mutex> g(cerrojo);
+        if (tareas.empty()) return false;
+        tarea = tareas.front();
+        tareas.pop_front();
+        return true;
+    }
+};
+
+} // namespace
+
+void PoolTrabajo::ejecutar(size_t num_tareas, const function<void(size_t, unsigned)>& tarea) {
+    if (num_tareas == 0) return;
+    const unsigned n = static_cast<unsigned>(min<size_t>(num_hilos, num_tareas));
+
+    if (n == 1) {
+        for (size_t i = 0; i < num_tareas; ++i) tarea(i, 0);
+        return;
+    }
+
+    // Rangos contiguos; el dueño los recorre en orden (saca por atrás)
+    vector<ColaTareas> colas(n);
+    for (unsigned h = 0; h < n; ++h) {
+        size_t ini = num_tareas * h / n;
+        size_t fin = num_tareas * (h + 1) / n;
+        for (size_t i = fin; i > ini; --i) colas[h].tareas.push_back(i - 1);
+    }
+
+    // Las tareas no generan otras: cuando ninguna cola tiene nada, se termina
+    auto trabajador = [&](unsigned yo) {
+        size_t t;
+        for (;;) {
+            if (colas[yo].sacar(t)) {
+                tarea(t, yo);
+                continue;
+            }
+            bool robada = false;
+            for (unsigned k = 1; k < n && !robada; ++k) {
+                robada = colas[(yo + k) % n].robar(t);
+            }
+            if (!robada) return;
+            tarea(t, yo);
+        }
+    };
+
+    vector<thread> hilos;
+    for (unsigned h = 1; h < n; ++h) hilos.emplace_back(trabajador, h);
+    trabajador(0);
+    for (auto& h : hilos) h.join();
+}
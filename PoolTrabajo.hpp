@@ -0,0 +1,30 @@
+#ifndef POOL_TRABAJO_HPP
+#define POOL_TRABAJO_HPP
+
+#include <cstddef>
+#include <functional>
+
+using namespace std;
+
+// --- POOL DE HILOS CON ROBO DE TAREAS ---
+// Las tareas se reparten al inicio en colas por hilo (rangos contiguos). Cada
+// hilo consume su cola por el final y, cuando se queda sin trabajo, roba por
+// el principio de la cola de otro hilo. Así un archivo grande no deja a los
+// demás hilos esperando mientras otro acumula tareas pendientes.
+
+class PoolTrabajo {
+private:
+    unsigned num_hilos;
+
+public:
+    // 0 = un hilo por núcleo
+    explicit PoolTrabajo(unsigned hilos = 0);
+
+    unsigned hilos() const { return num_hilos; }
+
+    // Ejecuta tarea(i, hilo) para cada i en [0, num_tareas). 'hilo' identifica
+    // al trabajador (0..hilos()-1), para que cada uno use su propio estado.
+    void ejecutar(size_t num_tareas, const function<void(size_t tarea, unsigned hilo)>& tarea);
+};
+
+#endif // POOL_TRABAJO_HPP
@@ -0,0 +1,149 @@
+#ifndef SIMBOLOS_HPP
+#define SIMBOLOS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Lexico.hpp"
+
+using namespace std;
+
+// --- INTERNADOR DE SÍMBOLOS ---
+// Asigna a cada etiqueta un identificador denso de 32 bits la primera vez que
+// aparece. A partir de ahí las definiciones y referencias se guardan en
+// vectores indexados por ese ID: resolver una referencia es indexar un
+// arreglo, no volver a calcular el hash de la cadena.
+// Las etiquetas no distinguen mayúsculas: la clave se guarda en mayúsculas y,
+// a continuación, la grafía con que apareció la primera vez (la que lleva la
+// tabla de símbolos de un objeto ELF). Nombres y tablas viven en la arena del
+// ensamblador.
+
+const uint32_t SIN_SIMBOLO = 0xFFFFFFFFu;
+
+class InternadorSimbolos {
+private:
+    Arena& arena;
+
+    // Cada ID guarda dónde empieza su nombre (copiado en la arena, en
+    // mayúsculas y tal cual) y su largo
+    VectorArena<const char*> inicio;
+    VectorArena<uint32_t> largo;
+    VectorArena<uint32_t> hash_id;
+
+    // Direccionamiento abierto: casillas con ID + 1 (0 = vacía)
+    VectorArena<uint32_t> casillas;
+    size_t mascara;
+
+    static uint32_t hash_ci(string_view s) {
+        uint32_t h = 2166136261u;
+        for (char c : s) {
+            h ^= static_cast<uint8_t>(a_mayuscula(c));
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    bool coincide(uint32_t id, string_view s) const {
+        return largo[id] == s.size() && iguales_ci(s, nombre(id));
+    }
+
+    void crecer() {
+        VectorArena<uint32_t> nuevas(casillas.empty() ? 64 : casillas.size() * 2, 0,
+                                     AsignadorArena<uint32_t>(arena));
+        size_t nueva_mascara = nuevas.size() - 1;
+        for (uint32_t id = 0; id < hash_id.size(); ++id) {
+            size_t i = hash_id[id] & nueva_mascara;
+            while (nuevas[i] != 0) i = (i + 1) & nueva_mascara;
+            nuevas[i] = id + 1;
+        }
+        casillas.swap(nuevas);
+        mascara = nueva_mascara;
+    }
+
+public:
+    explicit InternadorSimbolos(Arena& a)
+        : arena(a), inicio(AsignadorArena<const char*>(a)), largo(AsignadorArena<uint32_t>(a)),
+          hash_id(AsignadorArena<uint32_t>(a)), casillas(AsignadorArena<uint32_t>(a)), mascara(0) {}
+
+    // Devuelve el ID de 'nombre', creándolo si es nuevo
+    uint32_t internar(string_view s) {
+        if (casillas.empty()) crecer();
+        uint32_t h = hash_ci(s);
+        size_t i = h & mascara;
+        while (casillas[i] != 0) {
+            uint32_t id = casillas[i] - 1;
+            if (hash_id[id] == h && coincide(id, s)) return id;
+            i = (i + 1) & mascara;
+        }
+
+        uint32_t id = static_cast<uint32_t>(hash_id.size());
+        char* copia = static_cast<char*>(arena.asignar(2 * s.size(), 1));
+        for (size_t k = 0; k < s.size(); ++k) {
+            copia[k] = a_mayuscula(s[k]);
+            copia[s.size() + k] = s[k];
+        }
+        inicio.push_back(copia);
+        largo.push_back(static_cast<uint32_t>(s.size()));
+        hash_id.push_back(h);
+        casillas[i] = id + 1;
+
+        // Factor de carga máximo 1/2
+        if (hash_id.size() * 2 > casillas.size()) crecer();
+        return id;
+    }
+
+    // ID de 'nombre' sin crearlo; SIN_SIMBOLO si nunca se internó
+    uint32_t buscar(string_view s) const {
+        if (casillas.empty()) return SIN_SIMBOLO;
+        uint32_t h = hash_ci(s);
+        size_t i = h & mascara;
+        while (casillas[i] != 0) {
+            uint32_t id = casillas[i] - 1;
+            if (hash_id[id] == h && coincide(id, s)) return id;
+            i = (i + 1) & mascara;
+        }
+        return SIN_SIMBOLO;
+    }
+
+    // Nombre en mayúsculas (válido hasta que se reinicie la arena)
+    string_view nombre(uint32_t id) const {
+        return string_view(inicio[id], largo[id]);
+    }
+
+    // Nombre tal como se escribió la primera vez en la fuente
+    string_view nombre_fuente(uint32_t id) const {
+        return string_view(inicio[id] + largo[id], largo[id]);
+    }
+
+    size_t cantidad() const { return hash_id.size(); }
+
+    // Casillas de la tabla y sondeos que hace buscar() para encontrar cada
+    // símbolo: se recorre la tabla, las búsquedas no llevan cuentas
+    void medir_sondeos(uint32_t& num_casillas, uint64_t& total, uint32_t& maximo) const {
+        num_casillas = static_cast<uint32_t>(casillas.size());
+        total = 0;
+        maximo = 0;
+        for (size_t i = 0; i < casillas.size(); ++i) {
+            if (casillas[i] == 0) continue;
+            const size_t ideal = hash_id[casillas[i] - 1] & mascara;
+            const uint32_t sondeos = static_cast<uint32_t>(((i - ideal) & mascara) + 1);
+            total += sondeos;
+            maximo = max(maximo, sondeos);
+        }
+    }
+
+    // Suelta las tablas sin tocar la arena; llamar antes de reiniciarla
+    void limpiar() {
+        inicio = VectorArena<const char*>(AsignadorArena<const char*>(arena));
+        largo = VectorArena<uint32_t>(AsignadorArena<uint32_t>(arena));
+        hash_id = VectorArena<uint32_t>(AsignadorArena<uint32_t>(arena));
+        casillas = VectorArena<uint32_t>(AsignadorArena<uint32_t>(arena));
+        mascara = 0;
+    }
+};
+
+#endif // SIMBOLOS_HPP
@@ -0,0 +1,329 @@
+#include "EnsambladorIA32.hpp"
+#include "PoolTrabajo.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// -----------------------------------------------------------------------------
+// Línea de comandos
+// -----------------------------------------------------------------------------
+
+struct OpcionesLinea {
+    vector<string> entradas;
+    string dir_salida = ".";
+    string dir_cache;       // vacío = sin modo incremental
+    string formato = "hex"; // hex, ihex, srec, bin o elf
+    unsigned hilos = 0;     // 0 = un hilo por núcleo
+    bool optimizar = false; // -O1
+    bool formas_fijas = false;
+    uint32_t alinear_bucles = 0;    // 0 = no
+    bool analizar = false;
+    Microarquitectura micro = Microarquitectura::Skylake;
+    bool estadisticas = false;      // --stats
+    string traza;                   // --traza: vacío = no
+};
+
+static void mostrar_uso(const char* programa) {
+    cerr << "Uso: " << programa << " [-j N] [-o DIR] [-f FORMATO] [-O1] [--formas-fijas] [--alinear-bucles N]\n"
+         << "       [--analizar MICRO] [--stats] [--traza ARCHIVO] [--cache DIR] archivo.asm...\n"
+         << "  -j N         hilos de trabajo (por defecto, uno por nucleo)\n"
+         << "  -o DIR       directorio de salida (por defecto, el actual)\n"
+         << "  -f FORMATO   hex (texto, por defecto), ihex (Intel HEX), srec (Motorola S-record),\n"
+         << "               bin (binario plano) o elf (objeto ELF32)\n"
+         << "  -O0, -O1     sin optimizar (por defecto) u optimizacion de mirilla: MOV r,0 -> XOR,\n"
+         << "               ADD r,1 -> INC, CMP r,0 -> TEST, IMUL -> SHL/LEA... si las banderas\n"
+         << "               no se leen despues; informa lo que cambio\n"
+         << "  --formas-fijas\n"
+         << "               imm32, disp32 y saltos rel32 siempre, para parchear el codigo (por\n"
+         << "               defecto, la codificacion mas corta de cada instruccion)\n"
+         << "  --alinear-bucles N\n"
+         << "               alinea a N bytes (16 o 32) el inicio de cada bucle (destino de un\n"
+         << "               salto hacia atras) rellenando con NOP de varios bytes\n"
+         << "  --analizar MICRO\n"
+         << "               escribe X.analisis.txt: por bloque basico, ciclos por iteracion\n"
+         << "               estimados, cadena de dependencias critica y presion por puerto\n"
+         << "               en MICRO (skylake, zen2 o silvermont)\n"
+         << "  --stats      informa por archivo el tiempo de cada fase, lineas, bytes emitidos,\n"
+         << "               referencias por tipo y tamano, y tamano y sondeos del hash de simbolos\n"
+         << "  --traza ARCHIVO\n"
+         << "               escribe una traza de eventos de Chrome (chrome://tracing, Perfetto)\n"
+         << "               con las fases de cada archivo en el hilo que lo ensamblo\n"
+         << "  --cache DIR  ensamblado incremental con cache por archivo en DIR\n"
+         << "Por cada archivo X.asm se generan X.hex, X.ihx, X.srec, X.bin o X.o, mas\n"
+         << "X.simbolos.txt y X.referencias.txt.\n"
+         << "Sin argumentos ensambla programa.asm en programa.hex, simbolos.txt y referencias.txt.\n";
+}
+
+static bool parsear_argumentos(int argc, char** argv, OpcionesLinea& op) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto valor = [&](string& destino) {
+            if (i + 1 >= argc) {
+                cerr << "Falta el valor de " << arg << endl;
+                return false;
+            }
+            destino = argv[++i];
+            return true;
+        };
+
+        if (arg == "-h" || arg == "--ayuda") {
+            return false;
+        } else if (arg.rfind("-j", 0) == 0) {
+            string n = arg.substr(2);
+            if (n.empty() && !valor(n)) return false;
+            char* fin = nullptr;
+            long v = strtol(n.c_str(), &fin, 10);
+            if (*fin != '\0' || v < 1) {
+                cerr << "Numero de hilos invalido: " << n << endl;
+                return false;
+            }
+            op.hilos = static_cast<unsigned>(v);
+        } else if (arg == "-o") {
+            if (!valor(op.dir_salida)) return false;
+        } else if (arg == "-f") {
+            if (!valor(op.formato)) return false;
+            if (op.formato != "hex" && op.formato != "ihex" && op.formato != "srec" && op.formato != "bin" &&
+                op.formato != "elf") {
+                cerr << "Formato desconocido: " << op.formato << endl;
+                return false;
+            }
+        } else if (arg == "-O0" || arg == "-O1") {
+            op.optimizar = arg == "-O1";
+        } else if (arg == "--formas-fijas") {
+            op.formas_fijas = true;
+        } else if (arg == "--alinear-bucles") {
+            string n;
+            if (!valor(n)) return false;
+            char* fin = nullptr;
+            long v = strtol(n.c_str(), &fin, 10);
+            if (*fin != '\0' || (v != 16 && v != 32)) {
+                cerr << "Alineacion de bucles invalida (16 o 32): " << n << endl;
+                return false;
+            }
+            op.alinear_bucles = static_cast<uint32_t>(v);
+        } else if (arg == "--analizar") {
+            string nombre;
+            if (!valor(nombre)) return false;
+            if (!buscar_microarquitectura(nombre, op.micro)) {
+                cerr << "Microarquitectura desconocida: " << nombre << endl;
+                return false;
+            }
+            op.analizar = true;
+        } else if (arg == "--stats") {
+            op.estadisticas = true;
+        } else if (arg == "--traza") {
+            if (!valor(op.traza)) return false;
+        } else if (arg == "--cache") {
+            if (!valor(op.dir_cache)) return false;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return false;
+        } else {
+            op.entradas.push_back(arg);
+        }
+    }
+    return !op.entradas.empty();
+}
+
+// Nombre base de las salidas: "dir/prog.asm" → "prog" ("-" → "stdin")
+static string nombre_base(const string& entrada) {
+    if (entrada == "-") return "stdin";
+    return fs::path(entrada).stem().string();
+}
+
+// -----------------------------------------------------------------------------
+// Traza de eventos (--traza)
+// -----------------------------------------------------------------------------
+
+struct RegistroTraza {
+    string entrada;
+    unsigned hilo = 0;
+    EstadisticasEnsamblado estadisticas;
+};
+
+static string cadena_json(const string& s) {
+    string r = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            r.push_back('\\');
+            r.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char u[8];
+            snprintf(u, sizeof(u), "\\u%04x", static_cast<unsigned>(c));
+            r += u;
+        } else {
+            r.push_back(c);
+        }
+    }
+    return r + "\"";
+}
+
+// Formato de eventos de traza de Chrome: un evento completo ("X") por
+// archivo y uno por cada fase dentro de él, en la fila del hilo de trabajo
+// que lo ensambló. Tiempos en microsegundos desde el primer evento.
+static bool escribir_traza(const string& ruta, const vector<RegistroTraza>& registros, unsigned hilos) {
+    uint64_t origen = UINT64_MAX;
+    for (const RegistroTraza& r : registros) {
+        for (uint64_t inicio : r.estadisticas.inicio_ns) {
+            if (inicio != 0) origen = min(origen, inicio);
+        }
+    }
+    auto microsegundos = [&](uint64_t ns) { return (ns - origen) / 1000.0; };
+
+    ofstream f(ruta);
+    f << fixed << setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (unsigned h = 0; h < hilos; ++h) {
+        f << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << h
+          << ", \"args\": {\"name\": \"trabajador " << h << "\"}},\n";
+    }
+    bool primero = true;
+    for (const RegistroTraza& r : registros) {
+        const EstadisticasEnsamblado& e = r.estadisticas;
+        uint64_t inicio = UINT64_MAX, fin = 0;
+        for (size_t k = 0; k < NUM_FASES_ENSAMBLADO; ++k) {
+            if (e.inicio_ns[k] == 0) continue;
+            inicio = min(inicio, e.inicio_ns[k]);
+            fin = max(fin, e.inicio_ns[k] + e.duracion_ns[k]);
+        }
+        if (fin == 0) continue; // no llegó a ensamblarse
+
+        f << (primero ? "" : ",\n") << "  {\"name\": " << cadena_json(r.entrada)
+          << ", \"cat\": \"archivo\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << r.hilo
+          << ", \"ts\": " << microsegundos(inicio) << ", \"dur\": " << (fin - inicio) / 1000.0
+          << ", \"args\": {\"lineas\": " << e.lineas << ", \"bytes_fuente\": " << e.bytes_fuente
+          << ", \"bytes_emitidos\": " << e.bytes_emitidos << "}}";
+        primero = false;
+        for (size_t k = 0; k < NUM_FASES_ENSAMBLADO; ++k) {
+            if (e.inicio_ns[k] == 0) continue;
+            f << ",\n  {\"name\": \"" << nombre_fase(static_cast<FaseEnsamblado>(k))
+              << "\", \"cat\": \"fase\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << r.hilo
+              << ", \"ts\": " << microsegundos(e.inicio_ns[k]) << ", \"dur\": " << e.duracion_ns[k] / 1000.0
+              << "}";
+        }
+    }
+    f << "\n]}\n";
+    f.close();
+    return !f.fail();
+}
+
+// -----------------------------------------------------------------------------
+// Modo original: programa.asm en el directorio actual
+// -----------------------------------------------------------------------------
+
+static int ensamblar_programa() {
+    EnsambladorIA32 ensamblador;
+
+    cout << "Iniciando ensamblado en una sola pasada (leyendo programa.asm)...\n";
+    ensamblador.ensamblar("programa.asm", thread::hardware_concurrency());
+
+    cout << "Resolviendo referencias pendientes...\n";
+    ensamblador.resolver_referencias_pendientes();
+
+    cout << "Generando programa.hex, simbolos.txt y referencias.txt...\n";
+    ensamblador.generar_hex("programa.hex");
+    ensamblador.generar_reportes();
+
+    cout << "Proceso finalizado correctamente. Revisa los archivos generados.\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Modo por lotes
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    if (argc == 1) return ensamblar_programa();
+
+    OpcionesLinea op;
+    if (!parsear_argumentos(argc, argv, op)) {
+        mostrar_uso(argv[0]);
+        return 2;
+    }
+
+    // Dos entradas con el mismo nombre base se pisarían las salidas
+    set<string> bases;
+    for (const auto& entrada : op.entradas) {
+        if (!bases.insert(nombre_base(entrada)).second) {
+            cerr << "Error: dos archivos generan la misma salida '" << nombre_base(entrada) << "'" << endl;
+            return 2;
+        }
+    }
+
+    error_code ec;
+    fs::create_directories(op.dir_salida, ec);
+    if (!op.dir_cache.empty()) fs::create_directories(op.dir_cache, ec);
+
+    PoolTrabajo pool(op.hilos);
+
+    // Un ensamblador por trabajador, reutilizado entre archivos (su arena
+    // conserva la memoria de la pasada anterior)
+    vector<unique_ptr<EnsambladorIA32>> ensambladores;
+    for (unsigned h = 0; h < pool.hilos(); ++h) ensambladores.emplace_back(new EnsambladorIA32());
+
+    // Con un solo archivo, sus trozos aprovechan todos los hilos
+    const unsigned hilos_por_archivo = op.entradas.size() == 1 ? pool.hilos() : 1;
+
+    // Sin --stats ni --traza no se toma ningún tiempo
+    const bool medir = op.estadisticas || !op.traza.empty();
+    vector<RegistroTraza> registros(op.traza.empty() ? 0 : op.entradas.size());
+
+    mutex cerrojo_mensajes;
+    atomic<int> fallidos(0);
+
+    pool.ejecutar(op.entradas.size(), [&](size_t i, unsigned hilo) {
+        const string& entrada = op.entradas[i];
+        const string base = (fs::path(op.dir_salida) / nombre_base(entrada)).string();
+
+        EnsambladorIA32& ensamblador = *ensambladores[hilo];
+        ostringstream mensajes;
+        ensamblador.redirigir_errores(mensajes);
+        ensamblador.usar_cache(op.dir_cache.empty()
+                                   ? string()
+                                   : (fs::path(op.dir_cache) / (nombre_base(entrada) + ".cache")).string());
+        ensamblador.usar_optimizacion(op.optimizar);
+        ensamblador.usar_formas_fijas(op.formas_fijas);
+        ensamblador.alinear_bucles(op.alinear_bucles);
+        ensamblador.usar_estadisticas(medir);
+
+        bool ok = ensamblador.ensamblar(entrada, hilos_por_archivo);
+        if (ok) {
+            if (op.optimizar && !op.formas_fijas) ensamblador.informe_optimizacion(mensajes);
+            ensamblador.resolver_referencias_pendientes();
+            if (op.formato == "bin") ok = ensamblador.generar_binario(base + ".bin");
+            else if (op.formato == "elf") ok = ensamblador.generar_elf(base + ".o");
+            else if (op.formato == "ihex") ok = ensamblador.generar_intel_hex(base + ".ihx");
+            else if (op.formato == "srec") ok = ensamblador.generar_srec(base + ".srec");
+            else ok = ensamblador.generar_hex(base + ".hex");
+            ok = ensamblador.generar_reportes(base + ".simbolos.txt", base + ".referencias.txt") && ok;
+            if (op.analizar) ok = ensamblador.generar_analisis(base + ".analisis.txt", op.micro) && ok;
+            if (op.estadisticas) ensamblador.informe_estadisticas(mensajes);
+        }
+        // Un archivo con errores de ensamblado también hace fallar el lote
+        if (!ok || ensamblador.con_errores()) ++fallidos;
+        if (!registros.empty()) registros[i] = {entrada, hilo, ensamblador.estadisticas()};
+
+        // Los mensajes de cada archivo salen juntos, con su nombre delante
+        const string texto = mensajes.str();
+        if (!texto.empty()) {
+            lock_guard<mutex> g(cerrojo_mensajes);
+            istringstream lineas(texto);
+            string linea;
+            while (getline(lineas, linea)) cerr << entrada << ": " << linea << '\n';
+        }
+    });
+
+    if (!op.traza.empty() && !escribir_traza(op.traza, registros, pool.hilos())) {
+        cerr << "No se pudo escribir la traza: " << op.traza << endl;
+        return 1;
+    }
+    return fallidos > 0 ? 1 : 0;
+}